@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace bench {
+
+// Cheap timestamp source: the TSC where available, otherwise steady_clock.
+// Ticks are converted to nanoseconds with a one-off calibration.
+class CycleClock {
+ public:
+  static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_lfence();
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  }
+
+  static double ns_per_tick() {
+    static const double value = calibrate();
+    return value;
+  }
+
+ private:
+  static double calibrate() {
+#if defined(__x86_64__) || defined(__i386__)
+    const auto wall_start = std::chrono::steady_clock::now();
+    const auto ticks_start = now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const auto ticks = now() - ticks_start;
+    const auto wall = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - wall_start);
+    return wall.count() / static_cast<double>(ticks);
+#else
+    return 1.0;
+#endif
+  }
+};
+
+// Log-linear histogram in the spirit of HdrHistogram: 32 sub-buckets per
+// power of two, so any recorded value is within ~3% of its bucket.
+class Histogram {
+ public:
+  static constexpr int SUB_BUCKET_BITS = 5;
+  static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+  void record(uint64_t value) {
+    ++m_counts[bucket_of(value)];
+    ++m_total;
+    m_max = std::max(m_max, value);
+    m_min = std::min(m_min, value);
+    m_sum += static_cast<double>(value);
+  }
+
+  void merge(const Histogram& other) {
+    for (size_t i = 0; i < m_counts.size(); ++i) {
+      m_counts[i] += other.m_counts[i];
+    }
+    m_total += other.m_total;
+    m_max = std::max(m_max, other.m_max);
+    m_min = std::min(m_min, other.m_min);
+    m_sum += other.m_sum;
+  }
+
+  uint64_t count() const { return m_total; }
+  uint64_t max() const { return m_max; }
+  uint64_t min() const { return m_total ? m_min : 0; }
+  double mean() const { return m_total ? m_sum / m_total : 0.0; }
+
+  uint64_t percentile(double p) const {
+    if (m_total == 0) {
+      return 0;
+    }
+    const auto target = static_cast<uint64_t>(p / 100.0 * (m_total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < m_counts.size(); ++i) {
+      seen += m_counts[i];
+      if (seen >= target) {
+        return std::min(upper_bound_of(i), m_max);
+      }
+    }
+    return m_max;
+  }
+
+ private:
+  static size_t bucket_of(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+      return static_cast<size_t>(value);
+    }
+    const int exponent = std::bit_width(value) - 1 - SUB_BUCKET_BITS;
+    const auto mantissa = (value >> exponent) & (SUB_BUCKETS - 1);
+    return static_cast<size_t>((exponent + 1) * SUB_BUCKETS + mantissa);
+  }
+
+  static uint64_t upper_bound_of(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+      return bucket;
+    }
+    const auto exponent = bucket / SUB_BUCKETS - 1;
+    const auto mantissa = bucket % SUB_BUCKETS;
+    return ((SUB_BUCKETS + mantissa + 1) << exponent) - 1;
+  }
+
+  std::array<uint64_t, (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS> m_counts{};
+  uint64_t m_total = 0;
+  uint64_t m_max = 0;
+  uint64_t m_min = UINT64_MAX;
+  double m_sum = 0.0;
+};
+
+// One benchmark result, emitted as a single JSON object per line so runs
+// from different commits can be diffed or loaded by any tooling.
+class Result {
+ public:
+  Result(std::string_view suite, std::string_view name) {
+    add("suite", suite);
+    add("name", name);
+  }
+
+  Result& add(std::string_view key, std::string_view value) {
+    m_fields.emplace_back(std::string(key), std::format("\"{}\"", value));
+    return *this;
+  }
+
+  Result& add(std::string_view key, double value) {
+    m_fields.emplace_back(std::string(key), std::format("{:.3f}", value));
+    return *this;
+  }
+
+  Result& add(std::string_view key, uint64_t value) {
+    m_fields.emplace_back(std::string(key), std::format("{}", value));
+    return *this;
+  }
+
+  Result& add_latency(const Histogram& ticks) {
+    const double scale = CycleClock::ns_per_tick();
+    add("samples", ticks.count());
+    add("mean_ns", ticks.mean() * scale);
+    for (double p : {50.0, 90.0, 99.0, 99.9, 99.99}) {
+      add(std::format("p{}_ns", p), ticks.percentile(p) * scale);
+    }
+    add("max_ns", ticks.max() * scale);
+    return *this;
+  }
+
+  std::string to_json() const {
+    std::string out = "{";
+    for (size_t i = 0; i < m_fields.size(); ++i) {
+      if (i > 0) {
+        out += ", ";
+      }
+      out += std::format("\"{}\": {}", m_fields[i].first, m_fields[i].second);
+    }
+    out += "}";
+    return out;
+  }
+
+ private:
+  std::vector<std::pair<std::string, std::string>> m_fields;
+};
+
+class Reporter {
+ public:
+  explicit Reporter(FILE* out) : m_out(out) {}
+
+  void report(const Result& result) {
+    std::fputs(result.to_json().c_str(), m_out);
+    std::fputc('\n', m_out);
+    std::fflush(m_out);
+  }
+
+ private:
+  FILE* m_out;
+};
+
+struct Options {
+  unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+  uint64_t messages = 1'000'000;
+
+  // 1, 2, 4, ... and max_threads itself, even if not a power of two.
+  std::vector<unsigned> thread_counts() const {
+    std::vector<unsigned> counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) {
+      counts.push_back(threads);
+    }
+    counts.push_back(std::max(1u, max_threads));
+    return counts;
+  }
+};
+
+void run_producer_latency(Reporter& reporter, const Options& options);
+void run_consumer_throughput(Reporter& reporter, const Options& options);
+void run_sink_bandwidth(Reporter& reporter, const Options& options);
+void run_format_throughput(Reporter& reporter, const Options& options);
+
+}  // namespace bench
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <log_library/sink.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace bench {
+
+// Discards everything; isolates the queue and formatting cost.
+class NullSink : public log_library::Sink {
+ public:
+  void write(std::string_view message, LogLevel level) override {
+    m_records.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void flush() override {}
+
+  uint64_t records() const { return m_records.load(); }
+
+ private:
+  std::atomic<uint64_t> m_records{0};
+};
+
+// Appends into a preallocated in-memory buffer that wraps when full.
+class MemorySink : public log_library::Sink {
+ public:
+  explicit MemorySink(size_t capacity = 64 * 1024 * 1024) {
+    m_buffer.resize(capacity);
+  }
+
+  void write(std::string_view message, LogLevel level) override {
+    if (m_offset + message.size() > m_buffer.size()) {
+      m_offset = 0;
+    }
+    message.copy(m_buffer.data() + m_offset, message.size());
+    m_offset += message.size();
+    m_records.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void flush() override {}
+
+  uint64_t records() const { return m_records.load(); }
+
+ private:
+  std::string m_buffer;
+  size_t m_offset = 0;
+  std::atomic<uint64_t> m_records{0};
+};
+
+}  // namespace bench
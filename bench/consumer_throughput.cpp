@@ -0,0 +1,81 @@
+#include <log_library/logger.h>
+#include <log_library/sinks/file_sink.h>
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "bench_harness.h"
+#include "bench_sinks.h"
+
+namespace bench {
+
+namespace {
+
+// Producers back off whenever the queue is full, so every record is
+// delivered and the rate is bounded by the consumer and its sink.
+void measure(Reporter& reporter, const Options& options,
+             std::string_view sink_name, unsigned threads,
+             const std::function<std::unique_ptr<log_library::Sink>()>& make) {
+  std::vector<std::unique_ptr<log_library::Sink>> sinks;
+  sinks.push_back(make());
+  log_library::Logger logger(std::move(sinks));
+
+  const uint64_t per_thread = options.messages / threads;
+  const auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&logger, per_thread, t] {
+      for (uint64_t i = 0; i < per_thread; ++i) {
+        while (!logger.push_log(LOG_LEVEL_INFO,
+                                "worker {} message {} value {:.2f}", t, i,
+                                i * 0.5)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  logger.shutdown();
+
+  const auto seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  const uint64_t delivered = per_thread * threads;
+
+  reporter.report(Result("consumer_throughput", "end_to_end")
+                      .add("sink", sink_name)
+                      .add("threads", uint64_t{threads})
+                      .add("delivered", delivered)
+                      .add("full_queue_retries", logger.dropped_count())
+                      .add("seconds", seconds)
+                      .add("messages_per_sec", delivered / seconds));
+}
+
+}  // namespace
+
+void run_consumer_throughput(Reporter& reporter, const Options& options) {
+  log_library::FileSinkConfig config;
+  config.log_directory = "./bench_logs/";
+  config.base_filename = "throughput";
+
+  for (const unsigned threads : options.thread_counts()) {
+    measure(reporter, options, "null", threads,
+            [] { return std::make_unique<NullSink>(); });
+    measure(reporter, options, "memory", threads,
+            [] { return std::make_unique<MemorySink>(); });
+    measure(reporter, options, "file", threads,
+            [&] { return log_library::create_file_sink(config); });
+  }
+
+  std::filesystem::remove_all(config.log_directory);
+}
+
+}  // namespace bench
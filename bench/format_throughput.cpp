@@ -0,0 +1,74 @@
+#include <log_library/internal/message_payload.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "bench_harness.h"
+
+namespace bench {
+
+namespace {
+
+using log_library::internal::MessagePayload;
+
+// Formats the same captured record repeatedly, once through the payload's
+// own formatter (the consumer's path) and once through std::vformat_to, into
+// a string that is cleared but never shrunk, as the consumer's chunk is.
+template <typename... Args>
+void measure(Reporter& reporter, const Options& options,
+             std::string_view name, std::format_string<Args...> fmt,
+             Args... args) {
+  const MessagePayload payload(LOG_LEVEL_INFO, fmt.get(), args...);
+  std::string out;
+  out.reserve(4096);
+
+  auto time = [&](auto&& format) {
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < options.messages; ++i) {
+      if (out.size() > 3072) {
+        out.clear();
+      }
+      format();
+    }
+    return std::chrono::duration<double, std::nano>(
+               std::chrono::steady_clock::now() - start)
+               .count() /
+           static_cast<double>(options.messages);
+  };
+
+  const double fast_ns = time([&] {
+    payload.formatter(out, payload.format_string, payload.arg_buffer);
+  });
+  const double vformat_ns = time([&] {
+    std::vformat_to(std::back_inserter(out), fmt.get(),
+                    std::make_format_args(args...));
+  });
+
+  reporter.report(Result("format_throughput", name)
+                      .add("messages", options.messages)
+                      .add("payload_ns", fast_ns)
+                      .add("vformat_ns", vformat_ns)
+                      .add("speedup", vformat_ns / fast_ns));
+}
+
+}  // namespace
+
+void run_format_throughput(Reporter& reporter, const Options& options) {
+  measure(reporter, options, "ints", "worker {} message {} of {}", 3,
+          uint64_t{123456789}, -42L);
+  measure(reporter, options, "mixed", "order {} filled @ {} by {}",
+          uint64_t{9000123}, 101.25, "exchange-gateway");
+  measure(reporter, options, "float", "latency {} ms, ratio {}", 0.731,
+          1.0f / 3.0f);
+  measure(reporter, options, "pointer", "released block {} ({} bytes)",
+          static_cast<const void*>(&options), sizeof(Options));
+  measure(reporter, options, "spec_fallback", "value {:.2f} id {:>8}", 3.14159,
+          77);
+}
+
+}  // namespace bench
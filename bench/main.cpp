@@ -0,0 +1,60 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+#include "bench_harness.h"
+
+// Usage: log_library_bench [--suite producer|consumer|sink|format]
+//                          [--threads N] [--messages N]
+//                          [--out results.jsonl]
+int main(int argc, char** argv) {
+  bench::Options options;
+  std::string_view suite;
+  const char* out_path = nullptr;
+
+  for (int i = 1; i < argc; i += 2) {
+    const std::string_view flag = argv[i];
+    if (i + 1 == argc) {
+      std::fprintf(stderr, "Missing value for option: %s\n", argv[i]);
+      return 1;
+    }
+    if (flag == "--suite") {
+      suite = argv[i + 1];
+    } else if (flag == "--threads") {
+      options.max_threads = static_cast<unsigned>(std::atoi(argv[i + 1]));
+    } else if (flag == "--messages") {
+      options.messages = std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (flag == "--out") {
+      out_path = argv[i + 1];
+    } else {
+      std::fprintf(stderr, "Unknown option: %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  FILE* out = out_path ? std::fopen(out_path, "w") : stdout;
+  if (!out) {
+    std::perror("fopen");
+    return 1;
+  }
+
+  bench::Reporter reporter(out);
+  if (suite.empty() || suite == "producer") {
+    bench::run_producer_latency(reporter, options);
+  }
+  if (suite.empty() || suite == "consumer") {
+    bench::run_consumer_throughput(reporter, options);
+  }
+  if (suite.empty() || suite == "sink") {
+    bench::run_sink_bandwidth(reporter, options);
+  }
+  if (suite.empty() || suite == "format") {
+    bench::run_format_throughput(reporter, options);
+  }
+
+  if (out != stdout) {
+    std::fclose(out);
+  }
+  return 0;
+}
@@ -0,0 +1,152 @@
+#include <log_library/logger.h>
+
+#include <format>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "bench_harness.h"
+#include "bench_sinks.h"
+
+namespace bench {
+
+struct Point {
+  int x;
+  int y;
+  int z;
+};
+
+}  // namespace bench
+
+template <>
+struct std::formatter<bench::Point> : std::formatter<std::string> {
+  auto format(const bench::Point& p, std::format_context& ctx) const {
+    return std::format_to(ctx.out(), "({}, {}, {})", p.x, p.y, p.z);
+  }
+};
+
+namespace bench {
+
+namespace {
+
+// Only pushes that were queued are timed. A push that finds the queue full
+// is retried after a yield, so the samples are of the enqueue path and not
+// of dropping.
+//
+// With a `batch_size` above 1, records are staged in a LogBatch and
+// published together, and each sample is a batch's time divided by its
+// size: the amortized cost per record. A batch during which the logger
+// dropped anything is retried whole; the null sink does not mind the
+// duplicates. full_queue_retries then counts the records dropped.
+template <typename PushFn>
+void measure(Reporter& reporter, const Options& options, std::string_view shape,
+             unsigned threads, PushFn push,
+             const log_library::LoggerConfig& config = {},
+             size_t batch_size = 1) {
+  std::vector<std::unique_ptr<log_library::Sink>> sinks;
+  sinks.push_back(std::make_unique<NullSink>());
+  log_library::Logger logger(std::move(sinks), config);
+
+  const uint64_t per_thread = options.messages / threads;
+  std::vector<Histogram> histograms(threads);
+  std::vector<std::thread> workers;
+
+  const auto push_batch = [&](uint64_t first) {
+    const auto dropped = logger.dropped_count();
+    auto batch = logger.begin_batch();
+    for (size_t k = 0; k < batch_size; ++k) {
+      push(logger, first + k);
+    }
+    batch.flush();
+    return logger.dropped_count() == dropped;
+  };
+
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      auto& histogram = histograms[t];
+      for (uint64_t i = 0; i < per_thread; i += batch_size) {
+        for (;;) {
+          const auto start = CycleClock::now();
+          const bool queued = batch_size == 1 ? push(logger, i) : push_batch(i);
+          const auto end = CycleClock::now();
+          if (queued) {
+            histogram.record((end - start) / batch_size);
+            break;
+          }
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  logger.shutdown();
+
+  Histogram total;
+  for (const auto& histogram : histograms) {
+    total.merge(histogram);
+  }
+
+  reporter.report(Result("producer_latency", "push_log")
+                      .add("shape", shape)
+                      .add("threads", uint64_t{threads})
+                      .add("batch", uint64_t{batch_size})
+                      .add("queue", config.thread_queue_capacity > 0
+                                        ? std::string_view("per_thread")
+                                        : std::string_view("shared"))
+                      .add("full_queue_retries", logger.dropped_count())
+                      .add_latency(total));
+}
+
+}  // namespace
+
+void run_producer_latency(Reporter& reporter, const Options& options) {
+  log_library::LoggerConfig shared;
+  log_library::LoggerConfig per_thread;
+  per_thread.thread_queue_capacity = 1024;
+
+  for (const unsigned threads : options.thread_counts()) {
+    measure(reporter, options, "no_args", threads,
+            [](log_library::Logger& logger, uint64_t) {
+              return logger.push_log(LOG_LEVEL_INFO, "static message");
+            });
+    measure(reporter, options, "one_int", threads,
+            [](log_library::Logger& logger, uint64_t i) {
+              return logger.push_log(LOG_LEVEL_INFO, "value {}", i);
+            });
+    measure(
+        reporter, options, "one_int", threads,
+        [](log_library::Logger& logger, uint64_t i) {
+          return logger.push_log(LOG_LEVEL_INFO, "value {}", i);
+        },
+        per_thread);
+    for (const auto* config : {&shared, &per_thread}) {
+      measure(
+          reporter, options, "one_int", threads,
+          [](log_library::Logger& logger, uint64_t i) {
+            return logger.push_log(LOG_LEVEL_INFO, "value {}", i);
+          },
+          *config, log_library::internal::BATCH_CAPACITY);
+    }
+    measure(reporter, options, "three_ints", threads,
+            [](log_library::Logger& logger, uint64_t i) {
+              return logger.push_log(LOG_LEVEL_INFO, "{} {} {}", i, i + 1,
+                                     i + 2);
+            });
+    measure(reporter, options, "double_and_string", threads,
+            [](log_library::Logger& logger, uint64_t i) {
+              return logger.push_log(LOG_LEVEL_INFO, "{} took {:.3f}ms",
+                                     std::string_view("request"), i * 0.25);
+            });
+    measure(reporter, options, "struct", threads,
+            [](log_library::Logger& logger, uint64_t i) {
+              const int v = static_cast<int>(i);
+              return logger.push_log(LOG_LEVEL_INFO, "point {}",
+                                     Point{v, v, v});
+            });
+  }
+}
+
+}  // namespace bench
@@ -0,0 +1,60 @@
+#include <log_library/sinks/file_sink.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+#include "bench_harness.h"
+
+namespace bench {
+
+namespace {
+
+// Drives a file sink directly, bypassing the queue, with files small enough
+// that rotation and cleanup are part of the measured cost.
+void measure(Reporter& reporter, uint64_t records, size_t record_size,
+             size_t max_file_size) {
+  log_library::FileSinkConfig config;
+  config.log_directory = "./bench_logs/";
+  config.base_filename = "bandwidth";
+  config.max_file_size = max_file_size;
+  config.system_max_use = max_file_size * 4;
+
+  std::string record(record_size - 1, 'x');
+  record.push_back('\n');
+
+  auto sink = log_library::create_file_sink(config);
+  const auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < records; ++i) {
+    sink->write(record, LOG_LEVEL_INFO);
+  }
+  sink->flush();
+  const auto seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  log_library::SinkMetrics metrics;
+  sink->collect_metrics(metrics);
+  sink.reset();
+
+  const double megabytes = static_cast<double>(records * record_size) /
+                           (1024.0 * 1024.0);
+  reporter.report(Result("sink_bandwidth", "file_sink")
+                      .add("record_bytes", uint64_t{record_size})
+                      .add("max_file_bytes", uint64_t{max_file_size})
+                      .add("records", records)
+                      .add("rotations", metrics.rotate_ns.count)
+                      .add("seconds", seconds)
+                      .add("mb_per_sec", megabytes / seconds));
+
+  std::filesystem::remove_all(config.log_directory);
+}
+
+}  // namespace
+
+void run_sink_bandwidth(Reporter& reporter, const Options& options) {
+  for (size_t record_size : {64, 256, 1024}) {
+    measure(reporter, options.messages, record_size, 64ULL * 1024 * 1024);
+  }
+}
+
+}  // namespace bench
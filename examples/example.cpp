@@ -2,11 +2,13 @@
 #include <log_library/sinks/file_sink.h>
 
 #include <chrono>
+#include <format>
 #include <memory>
 #include <thread>
 #include <vector>
 
 void worker_thread(int id) {
+  log_library::set_thread_name(std::format("worker-{}", id));
   log_library::log_info("Worker thread {} starting.", id);
   for (int i = 0; i < 5; ++i) {
     log_library::log_debug("Worker {} logging message #{}", id, i);
@@ -20,6 +22,7 @@ int main() {
   std::vector<std::unique_ptr<log_library::Sink>> sinks;
   sinks.push_back(log_library::create_file_sink());
   log_library::init_default_logger(std::move(sinks));
+  log_library::set_thread_name("main");
 
   log_library::log_info("Main thread started. Spawning workers.");
 
@@ -34,9 +37,7 @@ int main() {
 
   log_library::log_error("All workers finished. Main thread shutting down.");
 
-  if (auto* logger = log_library::default_logger(); logger) {
-    logger->shutdown();
-  }
+  log_library::shutdown_default_logger();
 
   return 0;
 }
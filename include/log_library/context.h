@@ -0,0 +1,54 @@
+#pragma once
+
+#include <format>
+#include <iterator>
+#include <string_view>
+
+#include "internal/context.hpp"
+
+namespace log_library {
+
+// Key/value pair attached to every record the calling thread logs while the
+// returned object is alive:
+//
+//   auto ctx = log_library::scoped_context("req", request.id);
+//   LOG_INFO("accepted");  // ... INFO [worker]: {req=42} accepted
+//
+// The value is formatted once, here; records only carry a version number
+// and the consumer renders the text it was sent when the context changed.
+// Scopes nest and must end on the thread that opened them, innermost first.
+class ScopedContext {
+ public:
+  template <typename T>
+  ScopedContext(std::string_view key, const T& value)
+      : m_previous_size(internal::t_context.rendered.size()) {
+    auto& stack = internal::t_context;
+    if (!stack.rendered.empty()) {
+      stack.rendered.push_back(' ');
+    }
+    stack.rendered.append(key);
+    stack.rendered.push_back('=');
+    std::format_to(std::back_inserter(stack.rendered), "{}", value);
+    stack.changed();
+  }
+
+  ~ScopedContext() {
+    auto& stack = internal::t_context;
+    stack.rendered.resize(m_previous_size);
+    stack.changed();
+  }
+
+  ScopedContext(const ScopedContext&) = delete;
+  ScopedContext& operator=(const ScopedContext&) = delete;
+
+ private:
+  size_t m_previous_size;
+};
+
+template <typename T>
+[[nodiscard]] ScopedContext scoped_context(std::string_view key,
+                                           const T& value) {
+  return ScopedContext(key, value);
+}
+
+}  // namespace log_library
@@ -0,0 +1,21 @@
+#pragma once
+
+namespace log_library {
+
+class Logger;
+
+// Opt-in handler for SIGSEGV, SIGABRT, SIGBUS and std::terminate. On a fatal
+// signal it stops producers and the consumer, drains what is still queued in
+// a minimal async-signal-safe form (level, thread and the unformatted format
+// string), appends a "fatal signal" record with a raw backtrace, syncs the
+// sinks and re-raises the signal with the previous disposition. If the
+// consumer does not park within about 100 ms, nothing queued is touched and
+// only the fatal record is written.
+//
+// With no argument the default logger current at crash time is used. An
+// alternate signal stack, so stack overflows are reported too, is set up
+// for the calling thread and for every thread that logs or names itself
+// for the first time afterwards.
+void install_crash_handler(Logger* logger = nullptr);
+
+}  // namespace log_library
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <string>
 
@@ -17,6 +18,20 @@ struct FileSinkConfig {
   std::string base_filename = "app";
 
   std::string file_extension = ".log";
+
+  // Writes each batch as a frame with a length, a sequence number and a
+  // CRC32C (see internal/segment_frame.hpp), so readers can detect and skip
+  // damaged regions. Framed segments are not plain text. Linux sink only.
+  bool framed = false;
+
+  // When the log file cannot be written (disk full, I/O errors, the file
+  // truncated under the mapping) the sink keeps up to this many bytes of
+  // records in memory and drops the rest, retrying every retry_interval
+  // from the consumer's idle wake-ups. Once it recovers it starts a new
+  // segment with a marker saying how many records were lost. Linux sink
+  // only.
+  size_t spill_bytes = 4ULL * 1024 * 1024;
+  std::chrono::milliseconds retry_interval{1000};
 };
 
 }  // namespace log_library
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace log_library::internal {
+
+// The calling thread's scoped context (see context.h), rendered once as
+// "key=value key=value" when it changes. Records carry only its version;
+// the text reaches the consumer as a context update queued ahead of the
+// first record that needs it.
+struct ContextStack {
+  std::string rendered;
+  // Bumped on every change, never 0 so that 0 can mean "no context".
+  uint32_t version = 0;
+  // Generation of the logger that last received this thread's context (0
+  // for none), and which version. Not its address: a logger allocated
+  // where a destroyed one was must not look like it already has it.
+  uint64_t published_to = 0;
+  uint32_t published_version = 0;
+
+  void changed() {
+    if (++version == 0) {
+      version = 1;
+    }
+  }
+
+  bool published(uint64_t logger) const {
+    return published_to == logger && published_version == version;
+  }
+};
+
+// Source of Logger generations, which start at 1.
+inline std::atomic<uint64_t> g_logger_generations{0};
+
+inline uint64_t next_logger_generation() {
+  return g_logger_generations.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+inline thread_local ContextStack t_context;
+
+inline uint32_t current_context_id() {
+  return t_context.rendered.empty() ? 0 : t_context.version;
+}
+
+// Queued in place of a record; the consumer takes ownership of `text`.
+struct ContextUpdate {
+  uint32_t version;
+  std::string* text;
+};
+
+// Context records start their message with "{key=value ...} ".
+inline void append_context(std::string& out, const std::string& rendered) {
+  out.push_back('{');
+  out.append(rendered);
+  out.append("} ");
+}
+
+}  // namespace log_library::internal
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define LOG_LIBRARY_CRC32C_SSE42 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define LOG_LIBRARY_CRC32C_ARMV8 1
+#endif
+
+namespace log_library::internal {
+
+// CRC32C (Castagnoli), as computed by the SSE4.2 and ARMv8 CRC
+// instructions. Calls chain: crc32c(crc32c(0, a), b) == crc32c(0, a + b).
+
+inline constexpr std::array<uint32_t, 256> CRC32C_TABLE = [] {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78u : crc >> 1;
+    }
+    table[i] = crc;
+  }
+  return table;
+}();
+
+inline uint32_t crc32c_software(uint32_t crc, const void* data,
+                                size_t size) noexcept {
+  auto* bytes = static_cast<const unsigned char*>(data);
+  crc = ~crc;
+  while (size-- > 0) {
+    crc = CRC32C_TABLE[(crc ^ *bytes++) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+#if defined(LOG_LIBRARY_CRC32C_SSE42)
+
+__attribute__((target("sse4.2"))) inline uint32_t crc32c_hardware(
+    uint32_t crc, const void* data, size_t size) noexcept {
+  auto* bytes = static_cast<const unsigned char*>(data);
+  uint64_t wide = ~crc;
+  for (; size >= 8; size -= 8, bytes += 8) {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    wide = _mm_crc32_u64(wide, word);
+  }
+  auto narrow = static_cast<uint32_t>(wide);
+  while (size-- > 0) {
+    narrow = _mm_crc32_u8(narrow, *bytes++);
+  }
+  return ~narrow;
+}
+
+inline bool crc32c_hardware_available() noexcept {
+  static const bool available = __builtin_cpu_supports("sse4.2");
+  return available;
+}
+
+#elif defined(LOG_LIBRARY_CRC32C_ARMV8)
+
+inline uint32_t crc32c_hardware(uint32_t crc, const void* data,
+                                size_t size) noexcept {
+  auto* bytes = static_cast<const unsigned char*>(data);
+  crc = ~crc;
+  for (; size >= 8; size -= 8, bytes += 8) {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    crc = __crc32cd(crc, word);
+  }
+  while (size-- > 0) {
+    crc = __crc32cb(crc, *bytes++);
+  }
+  return ~crc;
+}
+
+constexpr bool crc32c_hardware_available() noexcept { return true; }
+
+#else
+
+inline uint32_t crc32c_hardware(uint32_t crc, const void* data,
+                                size_t size) noexcept {
+  return crc32c_software(crc, data, size);
+}
+
+constexpr bool crc32c_hardware_available() noexcept { return false; }
+
+#endif
+
+inline uint32_t crc32c(uint32_t crc, const void* data, size_t size) noexcept {
+  if (crc32c_hardware_available()) {
+    return crc32c_hardware(crc, data, size);
+  }
+  return crc32c_software(crc, data, size);
+}
+
+}  // namespace log_library::internal
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace log_library::internal {
+
+// Consumer-side formatting without std::vformat_to's type-erased arguments
+// and per-character back_insert_iterator: the worst-case size is reserved
+// up front and every field is written straight into the string's storage.
+// Only replacement fields without a spec ("{}") take this path; anything
+// else reports failure and the caller falls back to std::vformat_to, so the
+// output is always exactly what std::format would produce.
+
+template <typename T>
+concept FastInteger =
+    std::integral<T> && !std::same_as<T, bool> && !std::same_as<T, char> &&
+    !std::same_as<T, wchar_t> && !std::same_as<T, char8_t> &&
+    !std::same_as<T, char16_t> && !std::same_as<T, char32_t> &&
+    sizeof(T) <= sizeof(uint64_t);
+
+template <typename T>
+concept FastFloat = std::same_as<T, float> || std::same_as<T, double>;
+
+template <typename T>
+concept FastPointer = std::same_as<T, const void*> ||
+                      std::same_as<T, void*> ||
+                      std::same_as<T, std::nullptr_t>;
+
+template <typename T>
+concept FastString = std::same_as<T, const char*> ||
+                     std::same_as<T, char*> ||
+                     std::same_as<T, std::string_view>;
+
+template <typename T>
+concept FastFormattable =
+    FastInteger<T> || FastFloat<T> || FastPointer<T> || FastString<T> ||
+    std::same_as<T, char> || std::same_as<T, bool>;
+
+namespace fast_format_detail {
+
+inline constexpr char DIGIT_PAIRS[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Writes `value` right-aligned so it ends just before `end`; returns the
+// first character written.
+inline char* write_unsigned_backwards(char* end, uint64_t value) {
+  while (value >= 100) {
+    const auto pair = static_cast<size_t>(value % 100) * 2;
+    value /= 100;
+    end -= 2;
+    std::memcpy(end, DIGIT_PAIRS + pair, 2);
+  }
+  if (value >= 10) {
+    end -= 2;
+    std::memcpy(end, DIGIT_PAIRS + value * 2, 2);
+  } else {
+    *--end = static_cast<char>('0' + value);
+  }
+  return end;
+}
+
+template <typename T>
+size_t max_size(const T& value) {
+  if constexpr (FastInteger<T>) {
+    // Digits plus a sign.
+    return std::numeric_limits<T>::digits10 + 2;
+  } else if constexpr (FastFloat<T>) {
+    // Shortest round-trip form, e.g. "-2.2250738585072014e-308".
+    return 32;
+  } else if constexpr (FastPointer<T>) {
+    return 2 + sizeof(void*) * 2;
+  } else if constexpr (std::same_as<T, std::string_view>) {
+    return value.size();
+  } else if constexpr (FastString<T>) {
+    return std::strlen(value);
+  } else if constexpr (std::same_as<T, bool>) {
+    return 5;
+  } else {
+    return 1;
+  }
+}
+
+template <typename T>
+char* write(char* out, const T& value) {
+  if constexpr (FastInteger<T>) {
+    char digits[24];
+    char* const end = digits + sizeof(digits);
+    uint64_t magnitude;
+    if constexpr (std::is_signed_v<T>) {
+      if (value < 0) {
+        *out++ = '-';
+        magnitude = 0 - static_cast<uint64_t>(value);
+      } else {
+        magnitude = static_cast<uint64_t>(value);
+      }
+    } else {
+      magnitude = value;
+    }
+    const char* begin = write_unsigned_backwards(end, magnitude);
+    const auto length = static_cast<size_t>(end - begin);
+    std::memcpy(out, begin, length);
+    return out + length;
+  } else if constexpr (FastFloat<T>) {
+    return std::to_chars(out, out + 32, value).ptr;
+  } else if constexpr (FastPointer<T>) {
+    *out++ = '0';
+    *out++ = 'x';
+    return std::to_chars(out, out + sizeof(void*) * 2,
+                         reinterpret_cast<uintptr_t>(
+                             static_cast<const void*>(value)),
+                         16)
+        .ptr;
+  } else if constexpr (FastString<T>) {
+    const std::string_view text(value);
+    std::memcpy(out, text.data(), text.size());
+    return out + text.size();
+  } else if constexpr (std::same_as<T, bool>) {
+    const std::string_view text = value ? "true" : "false";
+    std::memcpy(out, text.data(), text.size());
+    return out + text.size();
+  } else {
+    *out++ = value;
+    return out;
+  }
+}
+
+// The pack is small, so picking the argument for a field by index is a
+// short chain of compares.
+template <typename... Args>
+char* write_arg(char* out, size_t index, const Args&... args) {
+  size_t i = 0;
+  ((i++ == index ? (out = write(out, args), true) : false) || ...);
+  return out;
+}
+
+}  // namespace fast_format_detail
+
+// Appends `fmt` formatted with `args` to `out` and returns true, or leaves
+// `out` unchanged and returns false if `fmt` uses anything but plain "{}"
+// fields or has more fields than arguments.
+template <FastFormattable... Args>
+bool format_fast(std::string& out, std::string_view fmt, const Args&... args) {
+  using namespace fast_format_detail;
+
+  const size_t old_size = out.size();
+  const size_t bound = fmt.size() + (size_t{0} + ... + max_size(args));
+  bool ok = true;
+
+  out.resize_and_overwrite(old_size + bound, [&](char* data, size_t) {
+    char* dst = data + old_size;
+    const char* src = fmt.data();
+    const char* const end = src + fmt.size();
+    size_t next_arg = 0;
+
+    while (src != end) {
+      // Copy the literal run up to the next brace in one go.
+      const char* brace = src;
+      while (brace != end && *brace != '{' && *brace != '}') {
+        ++brace;
+      }
+      const auto run = static_cast<size_t>(brace - src);
+      std::memcpy(dst, src, run);
+      dst += run;
+      src = brace;
+      if (src == end) {
+        break;
+      }
+
+      if (src + 1 != end && src[1] == src[0]) {
+        // "{{" or "}}".
+        *dst++ = *src;
+        src += 2;
+      } else if (src[0] == '{' && src + 1 != end && src[1] == '}' &&
+                 next_arg < sizeof...(Args)) {
+        dst = write_arg(dst, next_arg++, args...);
+        src += 2;
+      } else {
+        ok = false;
+        return old_size;
+      }
+    }
+    return static_cast<size_t>(dst - data);
+  });
+  return ok;
+}
+
+}  // namespace log_library::internal
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <log_library/metrics.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+namespace log_library::internal {
+
+constexpr uint64_t METRICS_SAMPLE_PERIOD = 16;
+
+// Single-writer histogram readable from any thread. The writer uses plain
+// load/store pairs instead of read-modify-write operations, so recording is
+// as cheap as a few uncontended stores.
+class AtomicHistogram {
+ public:
+  void record(uint64_t ns) noexcept {
+    const auto bucket = std::min<size_t>(std::bit_width(ns),
+                                         LatencyHistogram::BUCKETS - 1);
+    bump(m_buckets[bucket], 1);
+    bump(m_count, 1);
+    bump(m_sum, ns);
+    if (ns > m_max.load(std::memory_order_relaxed)) {
+      m_max.store(ns, std::memory_order_relaxed);
+    }
+  }
+
+  LatencyHistogram snapshot() const noexcept {
+    LatencyHistogram result;
+    for (size_t i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+      result.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+    }
+    result.count = m_count.load(std::memory_order_relaxed);
+    result.sum_ns = m_sum.load(std::memory_order_relaxed);
+    result.max_ns = m_max.load(std::memory_order_relaxed);
+    return result;
+  }
+
+ private:
+  static void bump(std::atomic<uint64_t>& counter, uint64_t delta) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + delta,
+                  std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> m_buckets[LatencyHistogram::BUCKETS]{};
+  std::atomic<uint64_t> m_count{0};
+  std::atomic<uint64_t> m_sum{0};
+  std::atomic<uint64_t> m_max{0};
+};
+
+}  // namespace log_library::internal
@@ -1,14 +1,19 @@
 #pragma once
 
 #include <log_library/config.h>
+#include <log_library/internal/context.hpp>
+#include <log_library/internal/fast_format.hpp>
+#include <log_library/internal/thread_registry.hpp>
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <format>
 #include <iterator>
 #include <memory>
 #include <new>
 #include <string>
 #include <string_view>
-#include <thread>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -22,7 +27,7 @@ concept TriviallyCopyableArg = std::is_trivially_copyable_v<std::decay_t<T>>;
 
 template<typename... Args>
 concept FitsInLogBuffer =
-  sizeof(std::tuple<std::decay<Args> ...>) <= MAX_ARG_BUFFER_SIZE;
+  sizeof(std::tuple<std::decay_t<Args>...>) <= MAX_ARG_BUFFER_SIZE;
 
 template<typename... Args>
 concept LoggableArgs = (TriviallyCopyableArg<Args> && ...) && FitsInLogBuffer<Args...>;
@@ -32,9 +37,15 @@ struct MessagePayload {
                                  const std::byte*);
 
   std::string_view format_string;
-  std::thread::id thread_id;
   FormatterFunc formatter;
+  // Enqueue time, nanoseconds since the Unix epoch.
+  int64_t timestamp_ns;
   LogLevel level;
+  ThreadIndex thread_index;
+  // The record stands for this many: it was kept by 1-in-N sampling.
+  uint32_t sample_rate;
+  // Version of the producer's scoped context, 0 for none.
+  uint32_t context;
   alignas(std::max_align_t) std::byte arg_buffer[MAX_ARG_BUFFER_SIZE];
 
   MessagePayload() = default;
@@ -45,16 +56,50 @@ struct MessagePayload {
   template <typename... Args>
   requires LoggableArgs<Args ...>
   MessagePayload(LogLevel lvl, std::string_view fmt, Args&&... args)
+      : MessagePayload(lvl, 1, fmt, std::forward<Args>(args)...) {}
+
+  template <typename... Args>
+  requires LoggableArgs<Args ...>
+  MessagePayload(LogLevel lvl, uint32_t rate, std::string_view fmt,
+                 Args&&... args)
       : format_string(fmt),
-        thread_id(std::this_thread::get_id()),
         formatter(&format_message<std::decay_t<Args>...>),
-        level(lvl) {
+        timestamp_ns(now_ns()),
+        level(lvl),
+        thread_index(current_thread_index()),
+        sample_rate(rate),
+        context(current_context_id()) {
     using TupleType = std::tuple<std::decay_t<Args>...>;
 
     std::construct_at(reinterpret_cast<TupleType*>(arg_buffer),
                       std::forward<Args>(args)...);
   }
 
+  // A context update rather than a record: no formatter, and `context`
+  // is the version of the text held in the argument buffer.
+  explicit MessagePayload(const ContextUpdate& update)
+      : formatter(nullptr),
+        timestamp_ns(now_ns()),
+        level(LOG_LEVEL_NONE),
+        thread_index(current_thread_index()),
+        sample_rate(1),
+        context(update.version) {
+    std::construct_at(reinterpret_cast<std::string**>(arg_buffer),
+                      update.text);
+  }
+
+  bool is_context_update() const { return formatter == nullptr; }
+
+  std::string* context_text() const {
+    return *std::launder(reinterpret_cast<std::string* const*>(arg_buffer));
+  }
+
+ static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+  }
+
  private:
   template <typename... DecayedArgs>
   static void format_message(std::string& out, std::string_view fmt,
@@ -64,6 +109,11 @@ struct MessagePayload {
 
     std::apply(
         [&](const DecayedArgs&... args) {
+          if constexpr ((FastFormattable<DecayedArgs> && ...)) {
+            if (format_fast(out, fmt, args...)) {
+              return;
+            }
+          }
           std::vformat_to(std::back_inserter(out), fmt,
                           std::make_format_args(args...));
         },
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <new>
@@ -56,6 +57,54 @@ class MPSCQueue {
     }
   }
 
+  // Publishes up to `count` items with a single reservation of contiguous
+  // slots, so they stay adjacent in consumption order. Returns how many were
+  // published; the remainder did not fit.
+  size_t try_push_bulk(const T* items, size_t count) {
+    auto head = m_head.load(std::memory_order_acquire);
+    size_t reserved = 0;
+
+    for (;;) {
+      const auto tail = m_tail.load(std::memory_order_acquire);
+      if (tail > head) {
+        head = m_head.load(std::memory_order_acquire);
+        continue;
+      }
+
+      // The consumer releases slots in order, so everything below
+      // tail + Capacity is free once the head has been claimed.
+      reserved = std::min(count, Capacity - (head - tail));
+      if (reserved == 0) {
+        return 0;
+      }
+
+      if (m_head.compare_exchange_weak(head, head + reserved,
+                                       std::memory_order_release)) {
+        break;
+      }
+    }
+
+    for (size_t i = 0; i < reserved; ++i) {
+      const size_t index = (head + i) & MASK;
+      std::construct_at(std::launder(reinterpret_cast<T*>(&m_buffer[index])),
+                        items[i]);
+    }
+    for (size_t i = 0; i < reserved; ++i) {
+      m_turnstile[(head + i) & MASK].store(head + i + 1,
+                                           std::memory_order_release);
+    }
+    return reserved;
+  }
+
+  static constexpr size_t capacity() { return Capacity; }
+
+  // Occupancy as seen by the consumer; may lag behind concurrent producers.
+  size_t size_approx() const {
+    const auto tail = m_tail.load(std::memory_order_relaxed);
+    const auto head = m_head.load(std::memory_order_relaxed);
+    return head > tail ? head - tail : 0;
+  }
+
   bool try_pop(T& value) {
     auto tail = m_tail.load(std::memory_order_relaxed);
     const size_t index = tail & MASK;
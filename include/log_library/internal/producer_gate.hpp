@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "thread_registry.hpp"
+
+namespace log_library::internal {
+
+// Tracks producers currently inside a logger so shutdown can wait for them
+// without producers ever taking a lock. Each producer bumps a counter on a
+// stripe picked by its thread index, which keeps the counter cache lines
+// mostly thread-private. Entry and close are sequentially consistent, so
+// either the producer sees the gate closed or the closer sees its count.
+class ProducerGate {
+ public:
+  static constexpr size_t STRIPES = 16;
+
+  bool try_enter(ThreadIndex thread) noexcept {
+    m_stripes[thread % STRIPES].count.fetch_add(1);
+    if (m_closed.load()) [[unlikely]] {
+      leave(thread);
+      return false;
+    }
+    return true;
+  }
+
+  void leave(ThreadIndex thread) noexcept {
+    m_stripes[thread % STRIPES].count.fetch_sub(1, std::memory_order_release);
+  }
+
+  // Rejects new producers without waiting. Async-signal-safe.
+  void seal() noexcept { m_closed.store(true); }
+
+  // Rejects new producers and waits for the ones already inside to leave.
+  void close() noexcept {
+    seal();
+    for (const auto& stripe : m_stripes) {
+      while (stripe.count.load() != 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  bool is_closed() const noexcept {
+    return m_closed.load(std::memory_order_acquire);
+  }
+
+ private:
+  struct alignas(64) Stripe {
+    std::atomic<uint32_t> count{0};
+  };
+
+  Stripe m_stripes[STRIPES];
+  alignas(64) std::atomic<bool> m_closed{false};
+};
+
+}  // namespace log_library::internal
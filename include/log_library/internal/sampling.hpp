@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace log_library::internal {
+
+// Per-thread xorshift64* generator for probabilistic sampling: no shared
+// state, a handful of instructions per decision.
+class SampleRng {
+ public:
+  SampleRng() {
+    // Distinct per thread; quality beyond that does not matter here.
+    m_state = reinterpret_cast<uintptr_t>(this) * 0x9E3779B97F4A7C15ULL | 1;
+  }
+
+  uint64_t next() {
+    m_state ^= m_state >> 12;
+    m_state ^= m_state << 25;
+    m_state ^= m_state >> 27;
+    return m_state * 0x2545F4914F6CDD1DULL;
+  }
+
+ private:
+  uint64_t m_state;
+};
+
+inline thread_local SampleRng t_sample_rng;
+
+// True with probability 1/n.
+inline bool sample_one_in(uint32_t n) {
+  if (n <= 1) {
+    return true;
+  }
+  // Multiply-shift maps the top 32 bits onto [0, n) without a division.
+  const auto draw = static_cast<uint32_t>(t_sample_rng.next() >> 32);
+  return (uint64_t{draw} * n >> 32) == 0;
+}
+
+// True for the first of every `n` calls counted by `count`. Like
+// sample_one_in(), n <= 1 keeps every call.
+inline bool keep_every(uint32_t& count, uint32_t n) {
+  if (n <= 1) {
+    return true;
+  }
+  return count++ % n == 0;
+}
+
+// Sampled records start their message with "[1/N] ".
+inline void append_sample_rate(std::string& out, uint32_t rate) {
+  if (rate > 1) {
+    out.append("[1/");
+    out.append(std::to_string(rate));
+    out.append("] ");
+  }
+}
+
+}  // namespace log_library::internal
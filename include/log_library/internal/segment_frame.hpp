@@ -0,0 +1,57 @@
+#pragma once
+
+#include <log_library/internal/crc32c.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+namespace log_library::internal {
+
+// Framed segments (FileSinkConfig::framed): every write is a header
+// followed by `size` bytes of ordinary formatted records. Records never
+// straddle frames, and the headers let readers detect torn or overwritten
+// regions, resynchronize past them and seek by sequence number.
+struct FrameHeader {
+  uint32_t magic;
+  // Payload bytes after the header.
+  uint32_t size;
+  // Index of the frame's first record, counted per sink from its creation.
+  // Records the sink had to drop still take a number, so a gap means loss.
+  uint64_t sequence;
+  uint32_t records;
+  // CRC32C of the payload, then of the size, sequence and records fields.
+  uint32_t crc;
+};
+static_assert(sizeof(FrameHeader) == 24);
+
+// Bytes F1 'L' 'F' 1E on disk: never part of formatted text, so scanning
+// for the first byte finds frame candidates quickly.
+inline constexpr uint32_t FRAME_MAGIC = 0x1E464CF1;
+
+inline uint32_t frame_crc(uint32_t payload_crc,
+                          const FrameHeader& header) noexcept {
+  constexpr size_t FIELDS = offsetof(FrameHeader, crc) -
+                            offsetof(FrameHeader, size);
+  return crc32c(payload_crc, &header.size, FIELDS);
+}
+
+// The header at `data` if it starts a complete frame whose CRC matches.
+inline std::optional<FrameHeader> read_frame(const char* data,
+                                             size_t available) noexcept {
+  FrameHeader header;
+  if (available < sizeof(header)) {
+    return std::nullopt;
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (header.magic != FRAME_MAGIC ||
+      header.size > available - sizeof(header) ||
+      frame_crc(crc32c(0, data + sizeof(header), header.size), header) !=
+          header.crc) {
+    return std::nullopt;
+  }
+  return header;
+}
+
+}  // namespace log_library::internal
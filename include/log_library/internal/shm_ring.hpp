@@ -0,0 +1,89 @@
+#pragma once
+
+#include <log_library/config.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace log_library::internal {
+
+// Multi-producer ring in a named POSIX shared-memory segment, shared by any
+// number of processes and drained by a single collector process.
+//
+// It follows MPSCQueue: a head counter claimed with CAS, a per-slot turn
+// number, and in-order release by the reader. Unlike MPSCQueue it holds no
+// pointers. A record carries its text and its thread name inline, because
+// format strings and formatter functions mean nothing in another address
+// space. Records longer than one slot take several contiguous slots.
+//
+// A producer that dies between claiming and publishing would block the
+// reader for good. The reader therefore abandons a slot that stays
+// unpublished for longer than a stall timeout. Producers publish with a CAS,
+// so a record that was given up on is never published afterwards.
+class ShmRing {
+ public:
+  static constexpr size_t SLOT_SIZE = 256;
+  static constexpr size_t MAX_RECORD_SLOTS = 16;
+  static constexpr size_t MAX_THREAD_NAME = 31;
+
+  struct Record {
+    int64_t timestamp_ns = 0;
+    uint32_t pid = 0;
+    LogLevel level = LOG_LEVEL_INFO;
+    std::string thread_name;
+    std::string text;
+  };
+
+  // Attaches to the segment, creating and initializing it first if it does
+  // not exist; producers and the collector may start in any order.
+  // `slot_count` (rounded up to a power of two) only matters for the
+  // creator. Throws std::runtime_error on failure.
+  static std::unique_ptr<ShmRing> open(const std::string& name,
+                                       size_t slot_count);
+
+  // Removes the name; processes already attached keep their mapping.
+  static void unlink(const std::string& name);
+
+  ~ShmRing();
+  ShmRing(const ShmRing&) = delete;
+  ShmRing& operator=(const ShmRing&) = delete;
+
+  // Producer side. Never blocks and never allocates, so it is also safe
+  // from a signal handler. Text beyond what MAX_RECORD_SLOTS can hold is
+  // truncated. Returns false (and counts a drop) when the ring is full.
+  bool try_write(LogLevel level, int64_t timestamp_ns,
+                 std::string_view thread_name, std::string_view text) noexcept;
+
+  // Reader side; only one reader may be attached at a time.
+  bool try_read(Record& record, std::chrono::nanoseconds stall_timeout);
+
+  size_t slot_count() const noexcept;
+  uint64_t dropped() const noexcept;
+  uint64_t abandoned() const noexcept;
+
+ private:
+  struct Header;
+  struct Slot;
+
+  ShmRing(void* mapping, size_t mapping_size);
+
+  Slot& slot(uint64_t position) const noexcept;
+
+  void* m_mapping;
+  size_t m_mapping_size;
+  Header* m_header;
+  Slot* m_slots;
+  size_t m_mask;
+  uint32_t m_pid;
+
+  // Reader-side stall tracking.
+  uint64_t m_stalled_position = UINT64_MAX;
+  std::chrono::steady_clock::time_point m_stalled_since;
+};
+
+}  // namespace log_library::internal
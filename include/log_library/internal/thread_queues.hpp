@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "message_payload.hpp"
+#include "thread_registry.hpp"
+
+namespace log_library::internal {
+
+// Single-producer, single-consumer ring owned by one producer thread. A
+// record's stamp is its own timestamp (system_clock nanoseconds, taken when
+// it was logged), so merging by stamp puts the output in timestamp order.
+class ThreadQueue {
+ public:
+  struct Slot {
+    uint64_t stamp = 0;
+    MessagePayload payload;
+  };
+
+  // `capacity` must be a power of two.
+  explicit ThreadQueue(size_t capacity)
+      : m_mask(capacity - 1), m_slots(std::make_unique<Slot[]>(capacity)) {}
+
+  ThreadQueue(const ThreadQueue&) = delete;
+  ThreadQueue& operator=(const ThreadQueue&) = delete;
+
+  // Producer side.
+  template <typename... Args>
+  bool try_emplace(Args&&... args) {
+    const auto tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head_cache > m_mask) {
+      m_head_cache = m_head.load(std::memory_order_acquire);
+      if (tail - m_head_cache > m_mask) {
+        return false;
+      }
+    }
+
+    auto& slot = m_slots[tail & m_mask];
+    slot.payload = MessagePayload(std::forward<Args>(args)...);
+    slot.stamp = static_cast<uint64_t>(slot.payload.timestamp_ns);
+    publish(1);
+    return true;
+  }
+
+  // Producer side. Publishes as many of `items` as fit, all stamped with
+  // the time of publication. Returns how many were published.
+  size_t try_push_bulk(const MessagePayload* items, size_t count) {
+    const auto tail = m_tail.load(std::memory_order_relaxed);
+    if (capacity() - (tail - m_head_cache) < count) {
+      m_head_cache = m_head.load(std::memory_order_acquire);
+    }
+    const size_t pushed = std::min(count, capacity() - (tail - m_head_cache));
+
+    const auto stamp = static_cast<uint64_t>(MessagePayload::now_ns());
+    for (size_t i = 0; i < pushed; ++i) {
+      auto& slot = m_slots[(tail + i) & m_mask];
+      slot.payload = items[i];
+      slot.stamp = stamp;
+    }
+    publish(pushed);
+    return pushed;
+  }
+
+  // Producer side, right after publishing `count` items: whether the
+  // consumer had already taken everything before them, and so may be
+  // asleep. Pairs with recheck(): either the consumer sees the new items,
+  // or the producer sees it caught up.
+  bool consumer_caught_up(size_t count) const {
+    return m_tail.load(std::memory_order_relaxed) -
+               m_head.load(std::memory_order_seq_cst) <=
+           count;
+  }
+
+  size_t capacity() const { return m_mask + 1; }
+
+  size_t size_approx() const {
+    const auto head = m_head.load(std::memory_order_relaxed);
+    return m_tail.load(std::memory_order_relaxed) - head;
+  }
+
+  // Consumer side: the oldest record, or nullptr if the ring is empty.
+  const Slot* front() {
+    const auto head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail_cache) {
+      m_tail_cache = m_tail.load(std::memory_order_acquire);
+      if (head == m_tail_cache) {
+        return nullptr;
+      }
+    }
+    return &m_slots[head & m_mask];
+  }
+
+  // Consumer side, as front(), before going to sleep on an empty ring. The
+  // tail is read with a read-modify-write, as the producer publishes it:
+  // those are totally ordered, so whichever comes second sees the other
+  // side's progress, and the consumer's earlier pops with it.
+  const Slot* recheck() {
+    m_tail_cache = m_tail.fetch_add(0, std::memory_order_seq_cst);
+    return front();
+  }
+
+  // Consumer side; only after front() returned a slot.
+  void pop(MessagePayload& value) {
+    const auto head = m_head.load(std::memory_order_relaxed);
+    value = m_slots[head & m_mask].payload;
+    m_head.store(head + 1, std::memory_order_release);
+  }
+
+ private:
+  void publish(size_t count) {
+    m_tail.fetch_add(count, std::memory_order_seq_cst);
+  }
+
+  alignas(64) std::atomic<size_t> m_tail{0};
+  size_t m_head_cache = 0;
+  alignas(64) std::atomic<size_t> m_head{0};
+  size_t m_tail_cache = 0;
+  alignas(64) const size_t m_mask;
+  std::unique_ptr<Slot[]> m_slots;
+};
+
+// One ThreadQueue per producer thread, created on the thread's first
+// record and kept until the logger goes away (a thread index that is
+// reused gets the same ring back). The consumer merges the rings by stamp.
+//
+// Producers publish at different speeds, so a record is held back until
+// its stamp is `window` old: anything stamped earlier that is still
+// unpublished by then would come out of order. Output is in stamp order
+// as long as no producer takes longer than the window between taking a
+// record's timestamp and publishing it, which only a preemption at that
+// exact point can cause. Stamps ahead of the clock by more than the window
+// (it was set back) are not held.
+class ThreadQueues {
+ public:
+  // `capacity` is rounded up to a power of two.
+  ThreadQueues(size_t capacity, std::chrono::nanoseconds window);
+
+  ThreadQueues(const ThreadQueues&) = delete;
+  ThreadQueues& operator=(const ThreadQueues&) = delete;
+
+  // The calling thread's ring, or nullptr for threads the registry could
+  // not take (they all share index 0, so cannot have a ring of their own)
+  // and when the ring cannot be allocated.
+  ThreadQueue* local() {
+    const auto thread = current_thread_index();
+    if (thread == 0) [[unlikely]] {
+      return nullptr;
+    }
+    if (auto* queue = m_by_thread[thread].load(std::memory_order_acquire))
+        [[likely]] {
+      return queue;
+    }
+    return create(thread);
+  }
+
+  // The ring of `thread` if it already has one; never creates it.
+  ThreadQueue* find(ThreadIndex thread) const {
+    return m_by_thread[thread].load(std::memory_order_acquire);
+  }
+
+  size_t capacity() const { return m_capacity; }
+
+  // Consumer side. Takes the record with the lowest stamp across all
+  // rings, unless it is younger than the window. Otherwise returns false
+  // and sets `hold` to how long until the oldest record may go, or to zero
+  // if every ring is empty. With `drain`, the window is ignored.
+  bool pop(MessagePayload& value, bool drain, std::chrono::nanoseconds& hold);
+
+  // Depth of the ring the last record came from, for metrics.
+  size_t last_depth() const { return m_run ? m_run->size_approx() : 0; }
+
+ private:
+  ThreadQueue* create(ThreadIndex thread);
+
+  const size_t m_capacity;
+  const uint64_t m_window_ns;
+
+  std::unique_ptr<std::atomic<ThreadQueue*>[]> m_by_thread;
+  // Rings in creation order; the consumer scans the first m_count.
+  std::unique_ptr<std::atomic<ThreadQueue*>[]> m_rings;
+  std::atomic<size_t> m_count{0};
+  std::mutex m_create_mutex;
+  std::vector<std::unique_ptr<ThreadQueue>> m_owned;
+
+  // Consumer-side merge state. Records keep coming from m_run while their
+  // stamps stay at or below m_run_bound: the lowest front stamp of every
+  // other ring at the last scan, and no later than the window allows.
+  ThreadQueue* m_run = nullptr;
+  uint64_t m_run_bound = 0;
+};
+
+}  // namespace log_library::internal
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace log_library::internal {
+
+using ThreadIndex = std::uint16_t;
+
+// Index 0 is reserved for threads that could not be registered (registry
+// exhausted); they render as "?".
+constexpr size_t MAX_THREADS = 4096;
+constexpr ThreadIndex UNREGISTERED_THREAD = 0xFFFF;
+constexpr size_t MAX_THREAD_NAME_LENGTH = 31;
+
+struct ThreadName {
+  char data[MAX_THREAD_NAME_LENGTH + 1];
+  size_t size;
+
+  std::string_view view() const { return {data, size}; }
+};
+
+ThreadIndex register_current_thread();
+
+// Run on each thread as it registers, before its first record. Set by
+// install_crash_handler() to give the thread an alternate signal stack.
+inline std::atomic<void (*)()> g_on_thread_registered{nullptr};
+
+// Run by the crash handler on SIGBUS before anything else, with the faulting
+// address. Set by the file sink's mapping guard; does not return if the
+// fault was a store into a guarded mapping.
+inline std::atomic<void (*)(const void*)> g_recover_mapping_fault{nullptr};
+
+// Copies the name of a registered thread without locking or syscalls. Safe to
+// call from any thread, including signal handlers.
+ThreadName thread_name(ThreadIndex index) noexcept;
+
+std::uint32_t thread_os_id(ThreadIndex index) noexcept;
+
+inline thread_local ThreadIndex t_thread_index = UNREGISTERED_THREAD;
+
+inline ThreadIndex current_thread_index() {
+  if (t_thread_index == UNREGISTERED_THREAD) [[unlikely]] {
+    t_thread_index = register_current_thread();
+  }
+  return t_thread_index;
+}
+
+}  // namespace log_library::internal
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <string>
+
+namespace log_library::internal {
+
+// Renders "YYYY-MM-DDTHH:MM:SS.uuuuuuZ" in UTC. The calendar part only
+// changes once per second, so it is cached.
+class TimestampCache {
+ public:
+  void append(std::string& out, int64_t timestamp_ns) {
+    const int64_t seconds = timestamp_ns >= 0
+                                ? timestamp_ns / 1'000'000'000
+                                : (timestamp_ns + 1) / 1'000'000'000 - 1;
+    if (seconds != m_cached_seconds) {
+      refresh(seconds);
+    }
+    out.append(m_prefix);
+
+    auto micros = static_cast<uint32_t>(
+        (timestamp_ns - seconds * 1'000'000'000) / 1'000);
+    char digits[8] = {'.', '0', '0', '0', '0', '0', '0', 'Z'};
+    for (int i = 6; i >= 1; --i) {
+      digits[i] = static_cast<char>('0' + micros % 10);
+      micros /= 10;
+    }
+    out.append(digits, sizeof(digits));
+  }
+
+ private:
+  void refresh(int64_t seconds) {
+    using namespace std::chrono;
+    const sys_seconds time{std::chrono::seconds(seconds)};
+    const auto day = floor<days>(time);
+    const year_month_day date{day};
+    const hh_mm_ss clock{time - day};
+
+    m_prefix.clear();
+    std::format_to(std::back_inserter(m_prefix),
+                   "{:04}-{:02}-{:02}T{:02}:{:02}:{:02}",
+                   static_cast<int>(date.year()),
+                   static_cast<unsigned>(date.month()),
+                   static_cast<unsigned>(date.day()), clock.hours().count(),
+                   clock.minutes().count(), clock.seconds().count());
+    m_cached_seconds = seconds;
+  }
+
+  int64_t m_cached_seconds = INT64_MIN;
+  std::string m_prefix;
+};
+
+}  // namespace log_library::internal
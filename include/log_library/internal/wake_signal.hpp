@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <ctime>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace log_library::internal {
+
+// Wake-up channel between producers and the consumer that, unlike
+// std::atomic::wait, supports a deadline. Producers only pay for an atomic
+// increment plus a load unless the consumer is actually asleep.
+//
+// Usage on the consumer side: take a ticket with prepare(), poll for work,
+// and only if there is none call wait_until(ticket, ...).
+class WakeSignal {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  uint32_t prepare() const noexcept {
+    return m_epoch.load(std::memory_order_acquire);
+  }
+
+  // Async-signal-safe on Linux.
+  void notify() noexcept {
+    m_epoch.fetch_add(1);
+    if (m_sleepers.load() != 0) [[unlikely]] {
+      wake();
+    }
+  }
+
+  void wait(uint32_t ticket) noexcept {
+    wait_until(ticket, Clock::time_point::max());
+  }
+
+  void wait_until(uint32_t ticket, Clock::time_point deadline) noexcept {
+    m_sleepers.fetch_add(1);
+    if (m_epoch.load() == ticket) {
+      sleep(ticket, deadline);
+    }
+    m_sleepers.fetch_sub(1, std::memory_order_release);
+  }
+
+ private:
+#ifdef __linux__
+  void wake() noexcept {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_epoch),
+            FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+  }
+
+  void sleep(uint32_t ticket, Clock::time_point deadline) noexcept {
+    timespec timeout{};
+    timespec* timeout_ptr = nullptr;
+    if (deadline != Clock::time_point::max()) {
+      const auto remaining = deadline - Clock::now();
+      if (remaining <= Clock::duration::zero()) {
+        return;
+      }
+      const auto ns =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(remaining)
+              .count();
+      timeout.tv_sec = static_cast<time_t>(ns / 1'000'000'000);
+      timeout.tv_nsec = static_cast<long>(ns % 1'000'000'000);
+      timeout_ptr = &timeout;
+    }
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_epoch),
+            FUTEX_WAIT_PRIVATE, ticket, timeout_ptr, nullptr, 0);
+  }
+#else
+  void wake() noexcept {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_condition.notify_one();
+  }
+
+  void sleep(uint32_t ticket, Clock::time_point deadline) noexcept {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const auto changed = [&] { return m_epoch.load() != ticket; };
+    if (deadline == Clock::time_point::max()) {
+      m_condition.wait(lock, changed);
+    } else {
+      m_condition.wait_until(lock, deadline, changed);
+    }
+  }
+
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+#endif
+
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+  std::atomic<uint32_t> m_epoch{0};
+  std::atomic<uint32_t> m_sleepers{0};
+};
+
+}  // namespace log_library::internal
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <concepts>
+#include <format>
+#include <type_traits>
+
+namespace log_library {
+
+// Argument that is computed on the consumer thread, only for records that
+// actually get queued:
+//
+//   LOG_DEBUG("stats: {}", log_library::lazy([snapshot] {
+//     return summarize(snapshot);
+//   }));
+//
+// Like every other argument the closure is copied into the record, so it
+// must be trivially copyable and small. It runs after the call returns, so
+// capture by value; anything reached through a captured pointer must outlive
+// the record.
+template <typename F>
+struct Lazy {
+  F fn;
+};
+
+template <typename F>
+  requires std::is_trivially_copyable_v<F> && std::invocable<const F&>
+constexpr Lazy<F> lazy(F fn) {
+  return Lazy<F>{fn};
+}
+
+}  // namespace log_library
+
+template <typename F>
+struct std::formatter<log_library::Lazy<F>>
+    : std::formatter<std::decay_t<std::invoke_result_t<const F&>>> {
+  auto format(const log_library::Lazy<F>& value,
+              std::format_context& ctx) const {
+    return std::formatter<std::decay_t<std::invoke_result_t<const F&>>>::
+        format(value.fn(), ctx);
+  }
+};
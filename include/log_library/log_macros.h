@@ -0,0 +1,67 @@
+#pragma once
+
+// Statement-level front-end. Unlike the log_* functions, these check the
+// level before the arguments are evaluated: a statement below
+// LOG_ACTIVE_LEVEL compiles to nothing, and one below the logger's runtime
+// level costs a load and a branch.
+//
+// Kept out of logger.h because <syslog.h> also defines LOG_INFO and
+// LOG_DEBUG; include this header only where that does not collide.
+
+#include "logger.h"
+
+#define LOG_LIBRARY_LOG_TO(logger_expr, level, ...)          \
+  do {                                                       \
+    if constexpr ((level) >= LOG_ACTIVE_LEVEL) {             \
+      if (auto* log_library_logger_ = (logger_expr);         \
+          log_library_logger_ &&                             \
+          log_library_logger_->should_log(level)) {          \
+        log_library_logger_->push_log((level), __VA_ARGS__); \
+      }                                                      \
+    }                                                        \
+  } while (false)
+
+#define LOG_LIBRARY_LOG(level, ...) \
+  LOG_LIBRARY_LOG_TO(::log_library::default_logger(), level, __VA_ARGS__)
+
+#define LOG_DEBUG(...) LOG_LIBRARY_LOG(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_LIBRARY_LOG(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_LIBRARY_LOG(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_LIBRARY_LOG(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+// Sampled statements: kept records carry the rate ("[1/N] " before the
+// message) so downstream counts can be scaled back up. Skipped statements
+// do not evaluate their arguments either.
+//
+// LOG_EVERY_N keeps the first of every `n` executions of this statement on
+// each thread; LOG_SAMPLED keeps each execution with probability 1/n. Both
+// keep every execution when n <= 1. `n` is evaluated once, after the level
+// check; `keep` sees it as log_library_n_.
+#define LOG_LIBRARY_LOG_SAMPLED_TO(logger_expr, level, n, keep, ...)          \
+  do {                                                                        \
+    if constexpr ((level) >= LOG_ACTIVE_LEVEL) {                              \
+      if (auto* log_library_logger_ = (logger_expr);                          \
+          log_library_logger_ && log_library_logger_->should_log(level)) {    \
+        const ::std::uint32_t log_library_n_ = (n);                           \
+        if (keep) {                                                           \
+          log_library_logger_->push_sampled((level), log_library_n_,          \
+                                            __VA_ARGS__);                     \
+        }                                                                     \
+      }                                                                       \
+    }                                                                         \
+  } while (false)
+
+#define LOG_EVERY_N(level, n, ...)                                           \
+  do {                                                                       \
+    static thread_local ::std::uint32_t log_library_site_count_ = 0;         \
+    LOG_LIBRARY_LOG_SAMPLED_TO(                                              \
+        ::log_library::default_logger(), level, n,                           \
+        ::log_library::internal::keep_every(log_library_site_count_,         \
+                                            log_library_n_),                 \
+        __VA_ARGS__);                                                        \
+  } while (false)
+
+#define LOG_SAMPLED(level, n, ...)                                      \
+  LOG_LIBRARY_LOG_SAMPLED_TO(                                           \
+      ::log_library::default_logger(), level, n,                        \
+      ::log_library::internal::sample_one_in(log_library_n_), __VA_ARGS__)
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <concepts>
+#include <format>
+#include <type_traits>
+#include <utility>
+
+namespace log_library {
+
+// Customization point for logging types that are not trivially copyable or
+// do not fit in a record. The producer stores a compact snapshot; the
+// consumer rebuilds the value from it and formats it with std::formatter<T>,
+// so the formatting cost stays off the logging thread:
+//
+//   template <>
+//   struct log_library::loggable<Order> {
+//     struct snapshot_type {
+//       uint64_t id;
+//       char symbol[8];
+//       double price;
+//     };
+//     static snapshot_type encode(const Order& order);  // producer
+//     static Order decode(const snapshot_type& s);      // consumer
+//   };
+//
+// snapshot_type must be trivially copyable and, together with the other
+// arguments of the call, fit in a record. Specialize before the first log
+// call that uses T.
+template <typename T>
+struct loggable {};
+
+template <typename T>
+concept Loggable = requires(const T& value) {
+  typename loggable<T>::snapshot_type;
+  {
+    loggable<T>::encode(value)
+  } -> std::convertible_to<typename loggable<T>::snapshot_type>;
+  loggable<T>::decode(std::declval<const typename loggable<T>::snapshot_type&>());
+} && std::is_trivially_copyable_v<typename loggable<T>::snapshot_type>;
+
+namespace internal {
+
+template <typename T>
+struct Encoded {
+  typename loggable<T>::snapshot_type snapshot;
+};
+
+// Applied to every argument on the producer side: types with a loggable
+// specialization are replaced by their snapshot, everything else passes
+// through untouched.
+template <typename Arg>
+decltype(auto) capture(Arg&& arg) {
+  using T = std::remove_cvref_t<Arg>;
+  if constexpr (Loggable<T>) {
+    return Encoded<T>{loggable<T>::encode(arg)};
+  } else {
+    return std::forward<Arg>(arg);
+  }
+}
+
+}  // namespace internal
+}  // namespace log_library
+
+template <typename T>
+struct std::formatter<log_library::internal::Encoded<T>> : std::formatter<T> {
+  auto format(const log_library::internal::Encoded<T>& value,
+              std::format_context& ctx) const {
+    return std::formatter<T>::format(
+        log_library::loggable<T>::decode(value.snapshot), ctx);
+  }
+};
@@ -1,33 +1,199 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <format>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <string_view>
 #include <thread>
 #include <vector>
 
 #include "config.h"
+#include "context.h"
+#include "internal/histogram.hpp"
 #include "internal/message_payload.hpp"
 #include "internal/mpsc_queue.hpp"
+#include "internal/producer_gate.hpp"
+#include "internal/sampling.hpp"
+#include "internal/shm_ring.hpp"
+#include "internal/thread_queues.hpp"
+#include "internal/wake_signal.hpp"
+#include "lazy.h"
+#include "loggable.h"
+#include "logger_config.h"
+#include "metrics.h"
 #include "sink.h"
 
 namespace log_library {
 
+class Logger;
+
+namespace internal {
+
+struct CrashAccess;
+
+constexpr size_t BATCH_CAPACITY = 64;
+
+struct StagingBuffer {
+  Logger* owner = nullptr;
+  size_t size = 0;
+  MessagePayload payloads[BATCH_CAPACITY];
+};
+
+inline thread_local StagingBuffer* t_staging = nullptr;
+
+}  // namespace internal
+
+// Scoped batch returned by Logger::begin_batch(). While it is alive, records
+// the owning thread pushes to that logger are staged thread-locally and
+// published together with a single queue reservation and one wake-up, either
+// when the staging buffer fills or when the batch is flushed or destroyed.
+// A batch must stay on the thread that created it; nested batches are inert.
+class LogBatch {
+ public:
+  LogBatch(LogBatch&& other) noexcept;
+  LogBatch& operator=(LogBatch&&) = delete;
+  LogBatch(const LogBatch&) = delete;
+  LogBatch& operator=(const LogBatch&) = delete;
+  ~LogBatch();
+
+  void flush();
+
+ private:
+  friend class Logger;
+  explicit LogBatch(Logger* logger);
+
+  Logger* m_logger;
+};
+
+using SinkId = std::uint64_t;
+
 class Logger {
  public:
-  explicit Logger(std::vector<std::unique_ptr<Sink>> sinks);
+  // Sinks passed here get ids 1..N in order.
+  explicit Logger(std::vector<std::unique_ptr<Sink>> sinks,
+                  const LoggerConfig& config = {});
 
+  // Never blocks. Records below the runtime level are discarded; records
+  // that cannot be queued (queue full, or the logger is shutting down) are
+  // dropped and counted in dropped_count(). Returns whether the record was
+  // queued (or staged in an active batch).
   template <typename... Args>
-  void push_log(LogLevel level, std::format_string<Args...> fmt,
+  bool push_log(LogLevel level, std::format_string<Args...> fmt,
                 Args&&... args) {
-    if (m_queue.try_emplace(level, fmt.get(), std::forward<Args>(args)...)) {
-      m_signal.fetch_add(1, std::memory_order_release);
-      m_signal.notify_one();
+    return push_sampled(level, 1, fmt, std::forward<Args>(args)...);
+  }
+
+  // As push_log(), for a record the caller kept out of every `rate` (see
+  // LOG_EVERY_N and LOG_SAMPLED in log_macros.h). The rate is shown in the
+  // emitted record so counts can be scaled back up.
+  template <typename... Args>
+  bool push_sampled(LogLevel level, uint32_t rate,
+                    std::format_string<Args...> fmt, Args&&... args) {
+    if (!should_log(level)) {
+      return false;
+    }
+
+    if (m_shared_ring) {
+      return push_shared(level, rate, fmt, std::forward<Args>(args)...);
+    }
+
+    const bool adaptive = m_adaptive_sampling_depth != 0 &&
+                          level <= m_config.adaptive_sampling_level;
+    const bool context_pending = internal::current_context_id() != 0 &&
+                                 !internal::t_context.published(m_generation);
+
+    if (auto* staging = internal::t_staging;
+        staging && staging->owner == this) [[unlikely]] {
+      if (adaptive) [[unlikely]] {
+        const auto thread = internal::current_thread_index();
+        if (!m_gate.try_enter(thread)) {
+          m_dropped.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+        const bool kept = keep_adaptively(rate);
+        m_gate.leave(thread);
+        if (!kept) {
+          return false;
+        }
+      }
+      if (context_pending) [[unlikely]] {
+        publish_context(staging);
+      }
+      if (staging->size == internal::BATCH_CAPACITY) {
+        publish_staged(*staging);
+      }
+      staging->payloads[staging->size++] = internal::MessagePayload(
+          level, rate, fmt.get(),
+          internal::capture(std::forward<Args>(args))...);
+      return true;
+    }
+
+    const auto thread = internal::current_thread_index();
+    if (!m_gate.try_enter(thread)) [[unlikely]] {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    if (adaptive && !keep_adaptively(rate)) [[unlikely]] {
+      m_gate.leave(thread);
+      return false;
     }
-    // Silently drop if queue is full (non-blocking guarantee)
+
+    // A record whose context could not be queued would be shown without
+    // it, so it is dropped too.
+    const bool queued =
+        (!context_pending || publish_context(nullptr)) &&
+        enqueue(level, rate, fmt.get(),
+                internal::capture(std::forward<Args>(args))...);
+    if (!queued) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    m_gate.leave(thread);
+    return queued;
+  }
+
+  // Runtime level, on top of the compile-time LOG_ACTIVE_LEVEL floor.
+  // Check should_log() before building expensive arguments, or use the
+  // macros in log_macros.h which do that for you.
+  bool should_log(LogLevel level) const {
+    return level >= m_level.load(std::memory_order_relaxed);
+  }
+
+  void set_level(LogLevel level) {
+    m_level.store(level, std::memory_order_relaxed);
   }
 
+  LogLevel level() const { return m_level.load(std::memory_order_relaxed); }
+
+  [[nodiscard]] LogBatch begin_batch();
+
+  // The sink set can be changed while the logger runs. The consumer reads it
+  // through an atomically published snapshot and never takes a lock; these
+  // calls wait for the consumer to stop using the previous snapshot, then
+  // flush and destroy any sink that was dropped from it.
+  SinkId add_sink(std::unique_ptr<Sink> sink);
+  bool remove_sink(SinkId id);
+  bool replace_sink(SinkId id, std::unique_ptr<Sink> sink);
+  std::vector<SinkId> sink_ids() const;
+
+  uint64_t dropped_count() const {
+    return m_dropped.load(std::memory_order_relaxed);
+  }
+
+  // Snapshot of the logger's self-instrumentation. Everything is measured on
+  // the consumer side; producers only contribute the enqueue timestamp every
+  // record already carries.
+  LoggerMetrics metrics() const;
+
+  // Stops accepting records, waits for producers already inside push_log to
+  // finish, then drains the queue and flushes the sinks. Idempotent.
   void shutdown();
 
   Logger(const Logger&) = delete;
@@ -35,24 +201,166 @@ class Logger {
   ~Logger();
 
  private:
+  friend class LogBatch;
+  friend void shutdown_default_logger();
+  friend struct internal::CrashAccess;
+  struct SinkSet;
+
+  struct ConsumerContext;
+
+  using Queue = MPSCQueue<internal::MessagePayload, 1024>;
+  struct QueueDeleter {
+    void operator()(Queue* queue) const;
+  };
+  static std::unique_ptr<Queue, QueueDeleter> make_queue(int numa_node);
+
+  // Queues one payload on the calling thread's queue, or the shared one,
+  // and wakes the consumer if it may be asleep.
+  template <typename... Args>
+  bool enqueue(Args&&... args) {
+    if (auto* queue = m_thread_queues ? m_thread_queues->local() : nullptr) {
+      if (!queue->try_emplace(std::forward<Args>(args)...)) {
+        return false;
+      }
+      if (queue->consumer_caught_up(1)) {
+        m_signal.notify();
+      }
+      return true;
+    }
+    if (!m_queue->try_emplace(std::forward<Args>(args)...)) {
+      return false;
+    }
+    m_signal.notify();
+    return true;
+  }
+
+  // Adaptive sampling: whether to keep a record at or below
+  // adaptive_sampling_level, scaling its `rate` if it is kept. Producers
+  // only look at the queues from inside the gate, since a retired default
+  // logger frees them.
+  bool keep_adaptively(uint32_t& rate) const {
+    if (queue_depth() < m_adaptive_sampling_depth) [[likely]] {
+      return true;
+    }
+    if (!internal::sample_one_in(m_config.adaptive_sampling_rate)) {
+      return false;
+    }
+    // Saturates rather than wrapping to a rate that looks unsampled.
+    const uint64_t scaled = uint64_t{rate} * m_config.adaptive_sampling_rate;
+    rate = static_cast<uint32_t>(
+        std::min<uint64_t>(scaled, std::numeric_limits<uint32_t>::max()));
+    return true;
+  }
+
+  // Must not create the calling thread's ring; a thread without one has
+  // nothing queued in it.
+  size_t queue_depth() const {
+    const auto thread = internal::current_thread_index();
+    if (!m_thread_queues || thread == 0) {
+      return m_queue->size_approx();
+    }
+    const auto* queue = m_thread_queues->find(thread);
+    return queue ? queue->size_approx() : 0;
+  }
+
+  bool try_pop(internal::MessagePayload& payload, bool drain,
+               std::chrono::nanoseconds& hold);
   void consumer_thread_loop();
+  void process(const internal::MessagePayload& payload,
+               ConsumerContext& context);
+  void dispatch(ConsumerContext& context);
+  void report_metrics(ConsumerContext& context);
+  LoggerMetrics snapshot_metrics(const SinkSet& sinks) const;
+  void publish_staged(internal::StagingBuffer& staging);
+  bool publish_context(internal::StagingBuffer* staging);
 
+  // Shared-ring mode formats on the calling thread: the collector on the
+  // other side cannot run this process's formatters.
+  template <typename... Args>
+  bool push_shared(LogLevel level, uint32_t rate,
+                   std::format_string<Args...> fmt, Args&&... args) {
+    thread_local std::string buffer;
+    buffer.clear();
+    internal::append_sample_rate(buffer, rate);
+    if (internal::current_context_id() != 0) {
+      internal::append_context(buffer, internal::t_context.rendered);
+    }
+    std::format_to(std::back_inserter(buffer), fmt,
+                   std::forward<Args>(args)...);
+    return publish_shared(level, buffer);
+  }
+
+  bool publish_shared(LogLevel level, std::string_view text);
+  void swap_sink_set(std::unique_ptr<SinkSet> next);
+
+  // Read by every producer, written rarely: keep it off the lines producers
+  // write to.
+  alignas(64) std::atomic<LogLevel> m_level;
+  // Identifies this logger to per-thread state that outlives it.
+  const uint64_t m_generation;
+  internal::ProducerGate m_gate;
+  alignas(64) std::atomic<uint64_t> m_dropped{0};
   std::atomic<bool> m_done{false};
-  alignas(64) std::atomic<uint64_t> m_signal{0};
-  MPSCQueue<internal::MessagePayload, 1024> m_queue;
+  std::atomic<bool> m_consumer_halt{false};
+  std::atomic<bool> m_consumer_halted{false};
+  alignas(64) internal::WakeSignal m_signal;
+  // Separately allocated so its pages can be bound to a NUMA node. Not
+  // created in shared-ring mode, where records never pass through it.
+  std::unique_ptr<Queue, QueueDeleter> m_queue;
+  // Set when LoggerConfig::thread_queue_capacity is; m_queue then only
+  // takes records from threads without a queue of their own.
+  std::unique_ptr<internal::ThreadQueues> m_thread_queues;
+
+  LoggerConfig m_config;
+  // Queue depth at which adaptive sampling starts; 0 when it is off.
+  size_t m_adaptive_sampling_depth = 0;
+  alignas(64) std::atomic<uint64_t> m_processed{0};
+  std::atomic<size_t> m_queue_high_water{0};
+  internal::AtomicHistogram m_queue_latency;
+  internal::AtomicHistogram m_format_time;
+
+  alignas(64) std::atomic<const SinkSet*> m_sink_set{nullptr};
+  std::atomic<uint64_t> m_consumer_epoch{0};
+  std::atomic<bool> m_consumer_exited{false};
+  mutable std::mutex m_sink_update_mutex;
+  SinkId m_next_sink_id = 1;
+
+  std::unique_ptr<internal::ShmRing> m_shared_ring;
+  std::unique_ptr<ConsumerContext> m_consumer_context;
+
   std::jthread m_consumer_thread;
-  std::vector<std::unique_ptr<Sink>> m_sinks;
 };
 
+namespace internal {
+inline std::atomic<Logger*> g_default_logger{nullptr};
+}  // namespace internal
+
 // Global/default logger functions (optional but convenient)
 // This provides an easy migration path from the old singleton API.
-void init_default_logger(std::vector<std::unique_ptr<Sink>> sinks);
-Logger* default_logger();
+// init_default_logger is a no-op while a default logger is installed.
+void init_default_logger(std::vector<std::unique_ptr<Sink>> sinks,
+                         const LoggerConfig& config = {});
+
+// Unpublishes the default logger and shuts it down. Producers that already
+// hold the pointer finish or are counted as dropped; the object itself is
+// retired rather than freed so such late producers never touch freed memory.
+// Runs automatically during static destruction.
+void shutdown_default_logger();
+
+inline Logger* default_logger() {
+  return internal::g_default_logger.load(std::memory_order_acquire);
+}
+
+// Names the calling thread in every record it emits from now on (truncated to
+// 31 characters). Unnamed threads are shown by their OS thread id.
+void set_thread_name(std::string_view name);
 
+// Arguments are evaluated before these are called; see log_macros.h for
+// statements that skip them when the level is disabled.
 template <LogLevel level, typename... Args>
 inline void log(std::format_string<Args...> fmt, Args&&... args) {
   if constexpr (level >= LOG_ACTIVE_LEVEL) {
-    if (auto* logger = default_logger(); logger) {
+    if (auto* logger = default_logger(); logger && logger->should_log(level)) {
       logger->push_log(level, fmt, std::forward<Args>(args)...);
     }
   }
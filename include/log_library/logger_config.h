@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+namespace log_library {
+
+struct LoggerConfig {
+  // Initial runtime level; see Logger::set_level().
+  LogLevel level = LOG_LEVEL_DEBUG;
+
+  // When non-zero, the consumer emits a record with the logger's own metrics
+  // (see Logger::metrics()) at this interval.
+  std::chrono::milliseconds metrics_report_interval{0};
+
+  // When set, records are formatted on the calling thread and written to
+  // this named shared-memory ring (see tools/log_collector) instead of a
+  // local queue. The logger then runs no consumer thread and takes no
+  // sinks. The slot count only matters to whichever process creates the
+  // ring; a slot is 256 bytes.
+  std::string shared_ring;
+  size_t shared_ring_slots = 16384;
+
+  // Adaptive sampling: while the queue (with thread_queue_capacity, the
+  // calling thread's queue) is at least this full (a fraction of its
+  // capacity), records at or below adaptive_sampling_level are kept
+  // one in adaptive_sampling_rate, at random, instead of filling the queue
+  // and crowding out more important ones. Kept records show the rate. 0
+  // turns it off; it does not apply to shared-ring mode.
+  double adaptive_sampling_threshold = 0.0;
+  LogLevel adaptive_sampling_level = LOG_LEVEL_DEBUG;
+  uint32_t adaptive_sampling_rate = 10;
+
+  // When non-zero, each producer thread gets its own queue of this many
+  // records (rounded up to a power of two) instead of sharing one, so
+  // producers never write to the same cache lines. The consumer merges the
+  // queues in timestamp order, holding each record back for merge_window
+  // so that one published a little late by another thread can still go out
+  // ahead of it; only a producer preempted for longer than that between
+  // taking a record's timestamp and publishing it can come out of order.
+  // Records staged in a LogBatch are ordered by when the batch is
+  // published. Threads beyond the registry's limit share the regular
+  // queue, which is not merged: its records are not held back and may go
+  // out ahead of older ones still inside the window.
+  size_t thread_queue_capacity = 0;
+  std::chrono::microseconds merge_window{50};
+
+  // Placement of the consumer thread and the queue, so logging stays off
+  // the cores and memory of latency-critical threads. Linux only; ignored
+  // elsewhere. The logger constructor throws std::system_error if a
+  // setting cannot be applied.
+
+  // CPUs the consumer may run on. Empty leaves it wherever the scheduler
+  // puts it.
+  std::vector<int> consumer_cpus;
+
+  // Runs the consumer under SCHED_IDLE, so it only gets CPU time nothing
+  // else wants. Under sustained load the queue fills up and records are
+  // dropped sooner.
+  bool consumer_idle_priority = false;
+
+  // Nice value for the consumer when it is not at idle priority. 0 keeps
+  // the inherited value.
+  int consumer_nice = 0;
+
+  // NUMA node the queue storage is bound to. -1 leaves it to the default
+  // policy (first touch by the thread constructing the logger).
+  int queue_numa_node = -1;
+};
+
+}  // namespace log_library
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace log_library {
+
+// Power-of-two latency buckets: bucket i counts durations in
+// [2^(i-1), 2^i) nanoseconds, bucket 0 counts zero.
+struct LatencyHistogram {
+  static constexpr size_t BUCKETS = 64;
+
+  std::array<uint64_t, BUCKETS> buckets{};
+  uint64_t count = 0;
+  uint64_t sum_ns = 0;
+  uint64_t max_ns = 0;
+
+  // Upper bound of the bucket holding the p-th percentile (0-100).
+  uint64_t percentile_ns(double p) const {
+    if (count == 0) {
+      return 0;
+    }
+    const auto target = static_cast<uint64_t>(p / 100.0 * (count - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      seen += buckets[i];
+      if (seen >= target) {
+        const uint64_t upper = i == 0 ? 0 : (uint64_t{1} << i) - 1;
+        return upper < max_ns ? upper : max_ns;
+      }
+    }
+    return max_ns;
+  }
+
+  uint64_t mean_ns() const { return count ? sum_ns / count : 0; }
+};
+
+struct SinkMetrics {
+  uint64_t id = 0;
+  uint64_t records = 0;
+  uint64_t bytes = 0;
+  // Duration of each write_batch() call.
+  LatencyHistogram write_ns;
+  // Reported by the sink itself; empty for sinks that do not rotate/sync.
+  LatencyHistogram rotate_ns;
+  LatencyHistogram sync_ns;
+  uint64_t errors = 0;
+};
+
+struct LoggerMetrics {
+  // Records handed to the sinks.
+  uint64_t records_processed = 0;
+  uint64_t records_dropped = 0;
+  size_t queue_capacity = 0;
+  size_t queue_high_water = 0;
+  // Time from enqueue on the producer to dequeue on the consumer.
+  LatencyHistogram queue_latency_ns;
+  // Sampled: one in every METRICS_SAMPLE_PERIOD records is timed.
+  LatencyHistogram format_ns;
+  std::vector<SinkMetrics> sinks;
+};
+
+}  // namespace log_library
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <log_library/config.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace log_library {
+
+struct RecordView {
+  std::string_view text;
+  LogLevel level;
+};
+
+namespace internal {
+
+// Block of formatted records owned by the consumer. The consumer formats
+// straight into `bytes` and recycles the chunk once it holds the only
+// reference again.
+struct RecordChunk {
+  struct Entry {
+    uint32_t offset;
+    uint32_t size;
+    LogLevel level;
+  };
+
+  std::atomic<uint32_t> refs{1};
+  std::string bytes;
+  std::vector<Entry> entries;
+  std::vector<RecordView> views;
+};
+
+}  // namespace internal
+
+// Shared ownership of a chunk's memory, for sinks that hand record text to
+// I/O that completes after write_batch() returns.
+class ChunkRef {
+ public:
+  ChunkRef() = default;
+
+  explicit ChunkRef(internal::RecordChunk* chunk) noexcept : m_chunk(chunk) {
+    if (m_chunk) {
+      m_chunk->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  ChunkRef(const ChunkRef& other) noexcept : ChunkRef(other.m_chunk) {}
+
+  ChunkRef(ChunkRef&& other) noexcept : m_chunk(other.m_chunk) {
+    other.m_chunk = nullptr;
+  }
+
+  ChunkRef& operator=(ChunkRef other) noexcept {
+    std::swap(m_chunk, other.m_chunk);
+    return *this;
+  }
+
+  ~ChunkRef() { reset(); }
+
+  void reset() noexcept {
+    if (m_chunk &&
+        m_chunk->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete m_chunk;
+    }
+    m_chunk = nullptr;
+  }
+
+  // Adopts a reference the caller already owns.
+  static ChunkRef adopt(internal::RecordChunk* chunk) noexcept {
+    ChunkRef ref;
+    ref.m_chunk = chunk;
+    return ref;
+  }
+
+  internal::RecordChunk* get() const noexcept { return m_chunk; }
+
+  bool unique() const noexcept {
+    return m_chunk && m_chunk->refs.load(std::memory_order_acquire) == 1;
+  }
+
+ private:
+  internal::RecordChunk* m_chunk = nullptr;
+};
+
+// Consecutive records handed to a sink in one call, in queue order. The
+// views stay valid for the duration of the call; retain() keeps them valid
+// for as long as the returned reference lives.
+class RecordBatch {
+ public:
+  explicit RecordBatch(internal::RecordChunk& chunk) : m_chunk(&chunk) {}
+
+  std::span<const RecordView> records() const { return m_chunk->views; }
+  size_t size() const { return m_chunk->views.size(); }
+  size_t bytes() const { return m_chunk->bytes.size(); }
+
+  ChunkRef retain() const { return ChunkRef(m_chunk); }
+
+ private:
+  internal::RecordChunk* m_chunk;
+};
+
+}  // namespace log_library
@@ -1,18 +1,61 @@
 #pragma once
 
 #include <log_library/config.h>
+#include <log_library/metrics.h>
+#include <log_library/record_batch.h>
 
+#include <chrono>
 #include <string>
+#include <string_view>
 
 namespace log_library {
 
+namespace internal {
+class WakeSignal;
+}
+
 class Sink {
  public:
   virtual ~Sink() = default;
 
-  virtual void write(const std::string& message, LogLevel level) = 0;
+  virtual void write(std::string_view message, LogLevel level) = 0;
+
+  // The consumer hands over everything it formatted since the previous call
+  // in one batch, shared by all sinks without copying. Override to write it
+  // in one go (memcpy run, writev); the default forwards record by record.
+  virtual void write_batch(const RecordBatch& batch) {
+    for (const auto& record : batch.records()) {
+      write(record.text, record.level);
+    }
+  }
 
   virtual void flush() = 0;
+
+  // Sinks that hold records back (see BufferedSink) report when they next
+  // want on_deadline() called. The consumer wakes up for it even while the
+  // queue is idle; under load it may be late by a few records. Both run on
+  // the consumer thread.
+  virtual std::chrono::steady_clock::time_point deadline() const {
+    return std::chrono::steady_clock::time_point::max();
+  }
+  virtual void on_deadline() {}
+
+  // Called with the consumer's wake-up signal when the sink is handed to a
+  // logger. A sink whose deadline() can move earlier from another thread
+  // notifies it (async-signal-safe on Linux) so the consumer looks again;
+  // wrappers pass it on to their target.
+  virtual void bind_wake_signal(internal::WakeSignal* signal) {}
+
+  // Used by the crash handler once the process is already dying. Overrides
+  // may only do async-signal-safe work (no allocation, no locks); the
+  // defaults do nothing.
+  virtual void write_from_signal(std::string_view message, LogLevel level) {}
+  virtual void flush_from_signal() {}
+
+  // Adds sink-internal measurements (rotation/sync durations, error counts)
+  // to a metrics snapshot. Called from arbitrary threads, so anything read
+  // here must be safe to read concurrently with write().
+  virtual void collect_metrics(SinkMetrics& metrics) const {}
 };
 
 }  // namespace log_library
\ No newline at end of file
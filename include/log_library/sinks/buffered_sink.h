@@ -0,0 +1,60 @@
+#pragma once
+
+#include <log_library/config.h>
+#include <log_library/record_batch.h>
+#include <log_library/sink.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+namespace log_library {
+
+struct BufferedSinkConfig {
+  // Records are handed on once this many bytes have accumulated.
+  size_t buffer_bytes = 1024 * 1024;
+
+  // ... or once the oldest buffered record has waited this long.
+  std::chrono::milliseconds max_delay{5};
+
+  // ... or right after a record at or above this level. LOG_LEVEL_NONE
+  // disables level-triggered flushes.
+  LogLevel flush_level = LOG_LEVEL_ERROR;
+};
+
+// Coalesces the consumer's batches into fewer, larger ones for `target`, so
+// a sink doing a syscall per batch (or per record) does one per
+// buffer_bytes instead. The delay bound is enforced through the consumer's
+// deadline wake-up (Sink::deadline()), so it holds while the queue is idle.
+// Record boundaries and levels are kept: the target still sees a
+// RecordBatch.
+class BufferedSink : public Sink {
+ public:
+  BufferedSink(std::unique_ptr<Sink> target,
+               const BufferedSinkConfig& config = {});
+  ~BufferedSink() override;
+
+  void write(std::string_view message, LogLevel level) override;
+  void write_batch(const RecordBatch& batch) override;
+  void flush() override;
+  std::chrono::steady_clock::time_point deadline() const override;
+  void on_deadline() override;
+  void bind_wake_signal(internal::WakeSignal* signal) override;
+  void write_from_signal(std::string_view message, LogLevel level) override;
+  void flush_from_signal() override;
+  void collect_metrics(SinkMetrics& metrics) const override;
+
+ private:
+  void append(std::string_view message, LogLevel level);
+  void emit();
+  void emit_from_signal() noexcept;
+
+  std::unique_ptr<Sink> target_;
+  BufferedSinkConfig config_;
+  ChunkRef chunk_;
+  std::chrono::steady_clock::time_point deadline_ =
+      std::chrono::steady_clock::time_point::max();
+};
+
+}  // namespace log_library
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <log_library/sink.h>
+
+#include <memory>
+
+namespace log_library {
+
+// Writes records to an already open file descriptor (a pipe, a socket,
+// STDOUT_FILENO, ...), one writev() per batch. The descriptor is not closed
+// by the sink. POSIX only.
+std::unique_ptr<Sink> create_fd_sink(int fd);
+
+}  // namespace log_library
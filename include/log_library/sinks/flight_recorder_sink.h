@@ -0,0 +1,94 @@
+#pragma once
+
+#include <log_library/config.h>
+#include <log_library/sink.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace log_library {
+
+struct FlightRecorderConfig {
+  // Size of the preallocated arena; the oldest records are overwritten
+  // once it is full.
+  size_t capacity_bytes = 16ULL * 1024 * 1024;
+
+  // A record at or above this level dumps the arena, itself included.
+  // LOG_LEVEL_NONE disables level-triggered dumps.
+  LogLevel trigger_level = LOG_LEVEL_ERROR;
+
+  // When non-zero, this signal (e.g. SIGUSR2) requests a dump from every
+  // flight recorder in the process. A handler already installed for it
+  // keeps being called. Ignored on Windows.
+  int dump_signal = 0;
+};
+
+// Keeps the most recent records in memory and only writes them to `target`
+// when something goes wrong: a record at the trigger level, an explicit
+// request_dump(), the dump signal, or a crash (through the crash handler).
+// In steady state a record costs one memcpy into the arena.
+//
+// Everything except request_dump() runs on the logger's consumer thread, so
+// the arena has a single writer and needs no synchronization.
+class FlightRecorderSink : public Sink {
+ public:
+  FlightRecorderSink(std::unique_ptr<Sink> target,
+                     const FlightRecorderConfig& config = {});
+  ~FlightRecorderSink() override;
+
+  void write(std::string_view message, LogLevel level) override;
+  void flush() override;
+  std::chrono::steady_clock::time_point deadline() const override;
+  void on_deadline() override;
+  void bind_wake_signal(internal::WakeSignal* signal) override;
+  void write_from_signal(std::string_view message, LogLevel level) override;
+  void flush_from_signal() override;
+  void collect_metrics(SinkMetrics& metrics) const override;
+
+  // Asks for a dump. The consumer is woken up to take it, even while the
+  // logger is idle. Thread-safe and async-signal-safe.
+  void request_dump() noexcept;
+
+  uint64_t dump_count() const noexcept {
+    return dumps_.load(std::memory_order_relaxed);
+  }
+
+  // Records pushed out of the arena before they could be dumped.
+  uint64_t overwritten_count() const noexcept {
+    return overwritten_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  void append(std::string_view message, LogLevel level) noexcept;
+  void evict(size_t needed) noexcept;
+  void copy_in(uint64_t position, const void* data, size_t size) noexcept;
+  void copy_out(uint64_t position, void* out, size_t size) const noexcept;
+  bool signal_pending() const noexcept;
+  bool dump_pending() noexcept;
+  void dump(std::string_view reason);
+  void dump_from_signal() noexcept;
+
+  std::unique_ptr<Sink> target_;
+  FlightRecorderConfig config_;
+  std::unique_ptr<char[]> arena_;
+  // Monotonic byte positions; the live records are [tail_, head_).
+  uint64_t head_ = 0;
+  uint64_t tail_ = 0;
+  size_t record_count_ = 0;
+
+  std::atomic<bool> dump_requested_{false};
+  uint32_t seen_signal_generation_ = 0;
+  std::atomic<internal::WakeSignal*> wake_{nullptr};
+  // Entry in the dump signal's list of consumers to wake, or -1.
+  int signal_waker_ = -1;
+  std::atomic<uint64_t> dumps_{0};
+  std::atomic<uint64_t> overwritten_{0};
+  std::string scratch_;
+};
+
+}  // namespace log_library
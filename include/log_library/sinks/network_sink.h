@@ -0,0 +1,70 @@
+#pragma once
+
+#include <log_library/sink.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace log_library {
+
+enum class NetworkTransport {
+  // Local datagram socket, e.g. /dev/log or /run/systemd/journal/socket.
+  UnixDatagram,
+  // One RFC 5424 message per datagram.
+  Udp,
+  // RFC 5424 messages with RFC 6587 octet-counting framing.
+  Tcp,
+};
+
+enum class NetworkFormat {
+  // RFC 5424: <PRI>1 TIMESTAMP HOSTNAME APP-NAME PROCID - - MSG
+  Syslog,
+  // journald native protocol (PRIORITY=, SYSLOG_IDENTIFIER=, MESSAGE=).
+  // UnixDatagram only.
+  Journald,
+};
+
+struct NetworkSinkConfig {
+  NetworkTransport transport = NetworkTransport::UnixDatagram;
+
+  NetworkFormat format = NetworkFormat::Syslog;
+
+  // Socket path for UnixDatagram, host name or address otherwise. Host
+  // names are resolved once, when the sink is created.
+  std::string address = "/dev/log";
+
+  uint16_t port = 514;
+
+  std::string app_name = "app";
+
+  // Syslog facility; 1 is "user-level messages".
+  int facility = 1;
+
+  // Records the socket would not take yet are kept and retried with the
+  // next batch, or shortly on the consumer's deadline wake-up if none
+  // comes. Records that do not fit go to the fallback sink.
+  size_t retry_buffer_bytes = 1024 * 1024;
+
+  // While the remote is down, records go to the fallback sink and a
+  // reconnect is attempted at most this often.
+  std::chrono::milliseconds reconnect_interval{1000};
+
+  // How long the sink waits, when it is destroyed, for the socket to take
+  // buffered records; the rest go to the fallback sink. flush() itself
+  // never waits.
+  std::chrono::milliseconds flush_timeout{1000};
+};
+
+// Ships records to a local or remote log collector over a nonblocking
+// socket: sendmmsg() batches for datagram transports, one sendmsg() per
+// batch for TCP. When the remote is unreachable or the retry buffer is
+// full, records are written to `fallback` instead (for example a file
+// sink), or dropped and counted as errors if there is none. Throws
+// std::runtime_error if the address cannot be resolved. POSIX only.
+std::unique_ptr<Sink> create_network_sink(
+    const NetworkSinkConfig& config, std::unique_ptr<Sink> fallback = nullptr);
+
+}  // namespace log_library
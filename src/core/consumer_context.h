@@ -0,0 +1,93 @@
+#pragma once
+
+#include <log_library/internal/timestamp_format.hpp>
+#include <log_library/logger.h>
+#include <log_library/record_batch.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace log_library {
+
+// State private to the consumer thread. Records are formatted straight into
+// the current chunk, which is handed to every sink as one batch once the
+// queue runs dry or the chunk fills up.
+struct Logger::ConsumerContext {
+  static constexpr size_t CHUNK_BYTES = 64 * 1024;
+  static constexpr size_t SPARE_CHUNKS = 4;
+
+  std::string buffer;
+  internal::TimestampCache timestamps;
+  uint64_t formatted = 0;
+
+  ChunkRef chunk;
+  std::vector<ChunkRef> spare;
+
+  // Latest scoped context of each producer thread, by thread index.
+  struct ThreadContext {
+    uint32_t version = 0;
+    std::unique_ptr<std::string> text;
+  };
+  std::vector<ThreadContext> thread_contexts;
+
+  void set_thread_context(const internal::MessagePayload& update) {
+    if (update.thread_index >= thread_contexts.size()) {
+      thread_contexts.resize(update.thread_index + 1);
+    }
+    auto& slot = thread_contexts[update.thread_index];
+    slot.version = update.context;
+    slot.text.reset(update.context_text());
+  }
+
+  // Null if the record's context never arrived.
+  const std::string* thread_context(
+      const internal::MessagePayload& record) const {
+    if (record.thread_index >= thread_contexts.size()) {
+      return nullptr;
+    }
+    const auto& slot = thread_contexts[record.thread_index];
+    return slot.version == record.context ? slot.text.get() : nullptr;
+  }
+
+  internal::RecordChunk& current() {
+    if (!chunk.get()) {
+      chunk = take_chunk();
+    }
+    return *chunk.get();
+  }
+
+  // Called after the sinks returned. A chunk some sink retained stays out
+  // of rotation until that sink lets go of it.
+  void recycle() {
+    if (spare.size() < SPARE_CHUNKS) {
+      spare.push_back(std::move(chunk));
+    }
+    chunk.reset();
+  }
+
+ private:
+  ChunkRef take_chunk() {
+    for (auto& candidate : spare) {
+      if (candidate.unique()) {
+        ChunkRef taken = std::move(candidate);
+        std::swap(candidate, spare.back());
+        spare.pop_back();
+        auto* recycled = taken.get();
+        recycled->bytes.clear();
+        recycled->entries.clear();
+        recycled->views.clear();
+        return taken;
+      }
+    }
+
+    auto* fresh = new internal::RecordChunk;
+    fresh->bytes.reserve(CHUNK_BYTES + CHUNK_BYTES / 4);
+    return ChunkRef::adopt(fresh);
+  }
+};
+
+}  // namespace log_library
@@ -0,0 +1,339 @@
+#include <log_library/crash_handler.h>
+#include <log_library/logger.h>
+
+#ifndef _WIN32
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+#include "consumer_context.h"
+#include "sink_set.h"
+
+namespace log_library::internal {
+
+// Fixed-size, allocation-free line builder for the signal path.
+class SignalSafeLine {
+ public:
+  void append(std::string_view text) noexcept {
+    const size_t room = sizeof(m_data) - 1 - m_size;
+    const size_t count = text.size() < room ? text.size() : room;
+    std::memcpy(m_data + m_size, text.data(), count);
+    m_size += count;
+  }
+
+  void append_number(unsigned long long value, int base = 10) noexcept {
+    char digits[24];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value, base);
+    append(std::string_view(digits, end - digits));
+  }
+
+  void end_line() noexcept {
+    m_data[m_size++] = '\n';
+  }
+
+  std::string_view view() const noexcept { return {m_data, m_size}; }
+
+ private:
+  char m_data[2048];
+  size_t m_size = 0;
+};
+
+struct CrashAccess {
+  // Stops producers and the consumer. Unless the crash happened on the
+  // consumer thread itself, waits briefly for it to park. Returns whether
+  // the queues and sinks are now this thread's alone.
+  static bool halt(Logger& logger) noexcept {
+    logger.m_gate.seal();
+    logger.m_consumer_halt.store(true, std::memory_order_release);
+
+    if (std::this_thread::get_id() == logger.m_consumer_thread.get_id() ||
+        logger.m_consumer_exited.load(std::memory_order_acquire)) {
+      return true;
+    }
+
+    logger.m_signal.notify();
+
+#ifndef _WIN32
+    for (int i = 0; i < 100; ++i) {
+      if (logger.m_consumer_halted.load(std::memory_order_acquire)) {
+        return true;
+      }
+      const timespec pause{0, 1'000'000};
+      nanosleep(&pause, nullptr);
+    }
+#endif
+    return logger.m_consumer_halted.load(std::memory_order_acquire);
+  }
+
+  // Without `exclusive` the consumer may still be popping and writing, so
+  // only the fatal record goes out.
+  static void drain(Logger& logger, std::string_view last_record,
+                    bool exclusive) noexcept {
+    const auto* sinks = logger.m_sink_set.load();
+    if (exclusive) {
+      drain_queued(logger, *sinks);
+    }
+
+    for (const auto& entry : sinks->entries) {
+      entry.sink->write_from_signal(last_record, LOG_LEVEL_ERROR);
+      entry.sink->flush_from_signal();
+    }
+  }
+
+  static void drain_queued(Logger& logger,
+                           const Logger::SinkSet& sinks) noexcept {
+    MessagePayload payload;
+
+    // Records formatted but not yet handed to the sinks.
+    if (logger.m_consumer_context) {
+      if (const auto* chunk = logger.m_consumer_context->chunk.get()) {
+        for (const auto& entry : chunk->entries) {
+          const auto text =
+              std::string_view(chunk->bytes).substr(entry.offset, entry.size);
+          for (const auto& sink : sinks.entries) {
+            sink.sink->write_from_signal(text, entry.level);
+          }
+        }
+      }
+    }
+
+    std::chrono::nanoseconds hold;
+    while (logger.try_pop(payload, true, hold)) {
+      if (payload.is_context_update()) {
+        continue;
+      }
+      const auto name = thread_name(payload.thread_index);
+
+      SignalSafeLine line;
+      line.append(to_string(payload.level));
+      line.append(" [");
+      line.append(name.view());
+      line.append("]: ");
+      line.append(payload.format_string);
+      line.end_line();
+
+      for (const auto& entry : sinks.entries) {
+        entry.sink->write_from_signal(line.view(), payload.level);
+      }
+    }
+  }
+};
+
+}  // namespace log_library::internal
+
+namespace {
+
+using log_library::Logger;
+using log_library::internal::SignalSafeLine;
+
+std::atomic<Logger*> g_crash_logger{nullptr};
+std::atomic<bool> g_crash_in_progress{false};
+std::terminate_handler g_previous_terminate = nullptr;
+char g_terminate_reason[256] = {};
+
+void on_terminate() {
+  const char* reason = "std::terminate called";
+  if (auto exception = std::current_exception()) {
+    try {
+      std::rethrow_exception(exception);
+    } catch (const std::exception& e) {
+      reason = e.what();
+    } catch (...) {
+      reason = "std::terminate called with a non-standard exception";
+    }
+  }
+  std::strncpy(g_terminate_reason, reason, sizeof(g_terminate_reason) - 1);
+
+  if (g_previous_terminate) {
+    g_previous_terminate();
+  }
+  std::abort();
+}
+
+#ifndef _WIN32
+
+constexpr int FATAL_SIGNALS[] = {SIGSEGV, SIGABRT, SIGBUS};
+constexpr int MAX_FRAMES = 32;
+
+struct sigaction g_previous_actions[sizeof(FATAL_SIGNALS) /
+                                    sizeof(FATAL_SIGNALS[0])];
+
+const char* signal_name(int signo) {
+  switch (signo) {
+    case SIGSEGV:
+      return "SIGSEGV";
+    case SIGABRT:
+      return "SIGABRT";
+    case SIGBUS:
+      return "SIGBUS";
+  }
+  return "signal";
+}
+
+constexpr size_t ALTERNATE_STACK_SIZE = 64 * 1024;
+
+// The calling thread's alternate signal stack, disabled and unmapped when
+// the thread exits.
+struct AlternateStack {
+  void* memory = nullptr;
+
+  ~AlternateStack() {
+    if (!memory) {
+      return;
+    }
+    stack_t disable{};
+    disable.ss_flags = SS_DISABLE;
+    sigaltstack(&disable, nullptr);
+    munmap(memory, ALTERNATE_STACK_SIZE);
+  }
+};
+
+thread_local AlternateStack t_alternate_stack;
+
+// A stack overflow can only be reported from a stack of its own, and
+// sigaltstack is per thread. Threads that already have one (sanitizer
+// runtimes set their own) keep it.
+void install_alternate_stack() {
+  stack_t current{};
+  if (sigaltstack(nullptr, &current) == 0 &&
+      (current.ss_flags & SS_DISABLE) == 0) {
+    return;
+  }
+
+  void* memory = mmap(nullptr, ALTERNATE_STACK_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    return;
+  }
+  stack_t stack{};
+  stack.ss_sp = memory;
+  stack.ss_size = ALTERNATE_STACK_SIZE;
+  if (sigaltstack(&stack, nullptr) != 0) {
+    munmap(memory, ALTERNATE_STACK_SIZE);
+    return;
+  }
+  t_alternate_stack.memory = memory;
+}
+
+void restore_and_raise(int signo) {
+  for (size_t i = 0; i < std::size(FATAL_SIGNALS); ++i) {
+    if (FATAL_SIGNALS[i] == signo) {
+      sigaction(signo, &g_previous_actions[i], nullptr);
+    }
+  }
+  raise(signo);
+}
+
+void on_fatal_signal(int signo, siginfo_t* info, void*) {
+  // A SIGBUS from a file sink's mapping is recoverable; let the sink take
+  // it before anything is halted.
+  if (signo == SIGBUS && info) {
+    if (auto* recover = log_library::internal::g_recover_mapping_fault.load(
+            std::memory_order_acquire)) {
+      recover(info->si_addr);
+    }
+  }
+
+  if (g_crash_in_progress.exchange(true)) {
+    // A second fault, most likely inside this handler: give up at once.
+    signal(signo, SIG_DFL);
+    raise(signo);
+    return;
+  }
+
+  Logger* logger = g_crash_logger.load(std::memory_order_acquire);
+  if (!logger) {
+    logger = log_library::default_logger();
+  }
+
+  if (logger) {
+    void* frames[MAX_FRAMES];
+    const int depth = backtrace(frames, MAX_FRAMES);
+    const auto name = log_library::internal::thread_name(
+        log_library::internal::t_thread_index);
+
+    SignalSafeLine line;
+    line.append("ERROR [");
+    line.append(name.view());
+    line.append("]: fatal signal ");
+    line.append_number(static_cast<unsigned>(signo));
+    line.append(" (");
+    line.append(signal_name(signo));
+    line.append(")");
+    if (info && (signo == SIGSEGV || signo == SIGBUS)) {
+      line.append(" at 0x");
+      line.append_number(reinterpret_cast<uintptr_t>(info->si_addr), 16);
+    }
+    if (g_terminate_reason[0] != '\0') {
+      line.append(", terminate: ");
+      line.append(g_terminate_reason);
+    }
+    line.append(", backtrace:");
+    for (int i = 0; i < depth; ++i) {
+      line.append(" 0x");
+      line.append_number(reinterpret_cast<uintptr_t>(frames[i]), 16);
+    }
+    line.end_line();
+
+    const bool exclusive = log_library::internal::CrashAccess::halt(*logger);
+    log_library::internal::CrashAccess::drain(*logger, line.view(), exclusive);
+
+    backtrace_symbols_fd(frames, depth, STDERR_FILENO);
+  }
+
+  restore_and_raise(signo);
+}
+
+#endif
+
+void install_handlers() {
+  g_previous_terminate = std::set_terminate(on_terminate);
+
+#ifndef _WIN32
+  // backtrace() loads libgcc lazily on first use, which is not safe inside a
+  // signal handler, so warm it up here.
+  void* warmup[1];
+  backtrace(warmup, 1);
+
+  install_alternate_stack();
+  log_library::internal::g_on_thread_registered.store(
+      install_alternate_stack, std::memory_order_release);
+
+  struct sigaction action{};
+  action.sa_sigaction = on_fatal_signal;
+  action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+  sigemptyset(&action.sa_mask);
+
+  for (size_t i = 0; i < std::size(FATAL_SIGNALS); ++i) {
+    sigaction(FATAL_SIGNALS[i], &action, &g_previous_actions[i]);
+  }
+#endif
+}
+
+}  // namespace
+
+namespace log_library {
+
+void install_crash_handler(Logger* logger) {
+  g_crash_logger.store(logger, std::memory_order_release);
+
+  // Later calls only retarget the logger.
+  static std::once_flag installed;
+  std::call_once(installed, [] { install_handlers(); });
+}
+
+}  // namespace log_library
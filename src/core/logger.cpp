@@ -1,89 +1,623 @@
+#include <log_library/internal/shm_ring.hpp>
+#include <log_library/internal/timestamp_format.hpp>
 #include <log_library/logger.h>
 #include <log_library/sink.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <format>
+#include <future>
 #include <iterator>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
 #include <string>
+#include <system_error>
+#include <thread>
+
+#include "consumer_context.h"
+#include "placement.h"
+#include "sink_set.h"
 
 namespace {
-std::unique_ptr<log_library::Logger> g_default_logger = nullptr;
 std::mutex g_default_logger_mutex;
+
+void append_prefix(std::string& buffer,
+                   log_library::internal::TimestampCache& timestamps,
+                   int64_t timestamp_ns, LogLevel level,
+                   log_library::internal::ThreadIndex thread) {
+  const auto name = log_library::internal::thread_name(thread);
+
+  timestamps.append(buffer, timestamp_ns);
+  buffer.push_back(' ');
+  buffer.append(to_string(level));
+  buffer.append(" [");
+  buffer.append(name.view());
+  buffer.append("]: ");
+}
+
+// Drops staged payloads from `from` on and returns how many were records.
+// Context updates among them are freed and sent again with the thread's
+// next record.
+size_t discard_staged(log_library::internal::StagingBuffer& staging,
+                      size_t from) {
+  size_t records = 0;
+  for (size_t i = from; i < staging.size; ++i) {
+    const auto& payload = staging.payloads[i];
+    if (payload.is_context_update()) {
+      delete payload.context_text();
+      log_library::internal::t_context.published_to = 0;
+    } else {
+      ++records;
+    }
+  }
+  return records;
+}
+
+uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Owns a thread's staging buffer and detaches it before it is freed.
+struct StagingStorage {
+  std::unique_ptr<log_library::internal::StagingBuffer> buffer;
+
+  ~StagingStorage() { log_library::internal::t_staging = nullptr; }
+};
 }  // namespace
 
 namespace log_library {
 
-void init_default_logger(std::vector<std::unique_ptr<Sink>> sinks) {
+void init_default_logger(std::vector<std::unique_ptr<Sink>> sinks,
+                         const LoggerConfig& config) {
   std::lock_guard<std::mutex> lock(g_default_logger_mutex);
-  if (!g_default_logger) {
-    g_default_logger = std::make_unique<Logger>(std::move(sinks));
+  if (!internal::g_default_logger.load(std::memory_order_relaxed)) {
+    internal::g_default_logger.store(new Logger(std::move(sinks), config),
+                                     std::memory_order_release);
+  }
+}
+
+void shutdown_default_logger() {
+  std::lock_guard<std::mutex> lock(g_default_logger_mutex);
+  Logger* logger =
+      internal::g_default_logger.exchange(nullptr, std::memory_order_acq_rel);
+  if (!logger) {
+    return;
+  }
+
+  logger->shutdown();
+
+  // The consumer has exited, so the sinks can go now, and producers only
+  // touch the queues from inside the gate, which stays closed. Only the
+  // logger shell stays reachable for the rest of the process.
+  {
+    std::lock_guard<std::mutex> sinks_lock(logger->m_sink_update_mutex);
+    delete logger->m_sink_set.exchange(new Logger::SinkSet());
+    logger->m_queue.reset();
+    logger->m_thread_queues.reset();
+    logger->m_consumer_context.reset();
+  }
+  static auto* retired = new std::vector<Logger*>();
+  retired->push_back(logger);
+}
+
+namespace {
+struct DefaultLoggerReaper {
+  ~DefaultLoggerReaper() { shutdown_default_logger(); }
+} g_default_logger_reaper;
+}  // namespace
+
+Logger::Logger(std::vector<std::unique_ptr<Sink>> sinks,
+               const LoggerConfig& config)
+    : m_level(config.level),
+      m_generation(internal::next_logger_generation()),
+      m_queue(config.shared_ring.empty()
+                  ? make_queue(config.queue_numa_node)
+                  : nullptr),
+      m_config(config) {
+  if (config.adaptive_sampling_threshold < 0.0 ||
+      config.adaptive_sampling_threshold > 1.0 ||
+      config.adaptive_sampling_rate == 0) {
+    throw std::invalid_argument("Invalid adaptive sampling settings");
+  }
+  if (config.merge_window.count() < 0) {
+    throw std::invalid_argument("Invalid merge window");
+  }
+  if (config.thread_queue_capacity > 0 && config.shared_ring.empty()) {
+    m_thread_queues = std::make_unique<internal::ThreadQueues>(
+        config.thread_queue_capacity, config.merge_window);
+  }
+  // Adaptive sampling follows the in-process queues; a shared ring's depth
+  // is not tracked.
+  if (config.adaptive_sampling_threshold > 0.0 && config.shared_ring.empty()) {
+    const size_t capacity = m_thread_queues ? m_thread_queues->capacity()
+                                            : m_queue->capacity();
+    m_adaptive_sampling_depth = std::max<size_t>(
+        1, static_cast<size_t>(config.adaptive_sampling_threshold * capacity));
+  }
+
+  auto initial = std::make_unique<SinkSet>();
+  for (auto& sink : sinks) {
+    sink->bind_wake_signal(&m_signal);
+    initial->entries.push_back({m_next_sink_id++, std::move(sink),
+                                std::make_shared<SinkSet::Stats>()});
+  }
+
+  // The destructor does not run if the constructor throws, so the sink set
+  // is only published once nothing below can.
+  if (!config.shared_ring.empty()) {
+    if (!initial->entries.empty()) {
+      throw std::invalid_argument(
+          "A logger writing to a shared ring cannot own sinks");
+    }
+    m_shared_ring =
+        internal::ShmRing::open(config.shared_ring, config.shared_ring_slots);
+    m_sink_set.store(initial.release(), std::memory_order_release);
+    // There is no consumer to wait for when the sink set changes.
+    m_consumer_exited.store(true, std::memory_order_release);
+    return;
+  }
+
+  m_consumer_context = std::make_unique<ConsumerContext>();
+  m_sink_set.store(initial.release(), std::memory_order_release);
+
+  // The consumer places itself before touching anything, so its chunks are
+  // first touched on its own node.
+  std::promise<int> placed;
+  auto placement = placed.get_future();
+  m_consumer_thread = std::jthread([this, &placed] {
+    placed.set_value(internal::place_current_thread(m_config));
+    consumer_thread_loop();
+  });
+  if (const int error = placement.get(); error != 0) {
+    shutdown();
+    delete m_sink_set.exchange(nullptr);
+    throw std::system_error(error, std::system_category(),
+                            "Failed to place the log consumer thread");
   }
 }
 
-Logger* default_logger() {
-  return g_default_logger.get();
+std::unique_ptr<Logger::Queue, Logger::QueueDeleter> Logger::make_queue(
+    int numa_node) {
+  void* memory = internal::allocate_on_node(sizeof(Queue), numa_node);
+  return std::unique_ptr<Queue, QueueDeleter>(new (memory) Queue());
 }
 
-Logger::Logger(std::vector<std::unique_ptr<Sink>> sinks)
-    : m_sinks(std::move(sinks)) {
-  m_consumer_thread = std::jthread(&Logger::consumer_thread_loop, this);
+void Logger::QueueDeleter::operator()(Queue* queue) const {
+  queue->~Queue();
+  internal::free_on_node(queue, sizeof(Queue));
 }
 
 Logger::~Logger() {
   if (!m_done.load(std::memory_order_acquire)) {
     shutdown();
   }
+  delete m_sink_set.load(std::memory_order_acquire);
+}
+
+SinkId Logger::add_sink(std::unique_ptr<Sink> sink) {
+  std::lock_guard<std::mutex> lock(m_sink_update_mutex);
+  auto next = std::make_unique<SinkSet>(*m_sink_set.load());
+  const SinkId id = m_next_sink_id++;
+  sink->bind_wake_signal(&m_signal);
+  next->entries.push_back(
+      {id, std::move(sink), std::make_shared<SinkSet::Stats>()});
+  swap_sink_set(std::move(next));
+  return id;
+}
+
+bool Logger::remove_sink(SinkId id) {
+  std::lock_guard<std::mutex> lock(m_sink_update_mutex);
+  auto next = std::make_unique<SinkSet>(*m_sink_set.load());
+  const auto removed = std::erase_if(
+      next->entries, [id](const auto& entry) { return entry.id == id; });
+  if (removed == 0) {
+    return false;
+  }
+  swap_sink_set(std::move(next));
+  return true;
+}
+
+bool Logger::replace_sink(SinkId id, std::unique_ptr<Sink> sink) {
+  std::lock_guard<std::mutex> lock(m_sink_update_mutex);
+  auto next = std::make_unique<SinkSet>(*m_sink_set.load());
+  auto it = std::find_if(next->entries.begin(), next->entries.end(),
+                         [id](const auto& entry) { return entry.id == id; });
+  if (it == next->entries.end()) {
+    return false;
+  }
+  sink->bind_wake_signal(&m_signal);
+  it->sink = std::move(sink);
+  it->stats = std::make_shared<SinkSet::Stats>();
+  swap_sink_set(std::move(next));
+  return true;
+}
+
+LoggerMetrics Logger::metrics() const {
+  std::lock_guard<std::mutex> lock(m_sink_update_mutex);
+  return snapshot_metrics(*m_sink_set.load());
+}
+
+// Readers other than the consumer must hold m_sink_update_mutex so `sinks`
+// cannot be retired underneath them.
+LoggerMetrics Logger::snapshot_metrics(const SinkSet& sinks) const {
+  LoggerMetrics result;
+  result.records_processed = m_processed.load(std::memory_order_relaxed);
+  result.records_dropped = m_dropped.load(std::memory_order_relaxed);
+  result.queue_capacity = m_thread_queues ? m_thread_queues->capacity()
+                          : m_queue       ? m_queue->capacity()
+                                          : 0;
+  result.queue_high_water = m_queue_high_water.load(std::memory_order_relaxed);
+  result.queue_latency_ns = m_queue_latency.snapshot();
+  result.format_ns = m_format_time.snapshot();
+
+  for (const auto& entry : sinks.entries) {
+    SinkMetrics sink;
+    sink.id = entry.id;
+    sink.records = entry.stats->records.load(std::memory_order_relaxed);
+    sink.bytes = entry.stats->bytes.load(std::memory_order_relaxed);
+    sink.write_ns = entry.stats->write_time.snapshot();
+    entry.sink->collect_metrics(sink);
+    result.sinks.push_back(sink);
+  }
+  return result;
+}
+
+std::vector<SinkId> Logger::sink_ids() const {
+  std::lock_guard<std::mutex> lock(m_sink_update_mutex);
+  std::vector<SinkId> ids;
+  for (const auto& entry : m_sink_set.load()->entries) {
+    ids.push_back(entry.id);
+  }
+  return ids;
+}
+
+// Must be called with m_sink_update_mutex held. The consumer bumps its epoch
+// each time it is between records, so once the epoch moves past the value
+// observed after publishing, nothing can still hold the previous set.
+void Logger::swap_sink_set(std::unique_ptr<SinkSet> next) {
+  std::unique_ptr<const SinkSet> previous(m_sink_set.exchange(next.release()));
+
+  const auto epoch = m_consumer_epoch.load();
+  while (m_consumer_epoch.load() == epoch &&
+         !m_consumer_exited.load(std::memory_order_acquire)) {
+    m_signal.notify();
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+
+  const auto* current = m_sink_set.load();
+  for (const auto& entry : previous->entries) {
+    const bool retained = std::any_of(
+        current->entries.begin(), current->entries.end(),
+        [&](const auto& kept) { return kept.sink == entry.sink; });
+    if (!retained) {
+      entry.sink->flush();
+    }
+  }
+}
+
+LogBatch::LogBatch(Logger* logger) : m_logger(logger) {}
+
+LogBatch::LogBatch(LogBatch&& other) noexcept : m_logger(other.m_logger) {
+  other.m_logger = nullptr;
+}
+
+LogBatch::~LogBatch() {
+  if (!m_logger) {
+    return;
+  }
+  flush();
+  internal::t_staging->owner = nullptr;
+}
+
+void LogBatch::flush() {
+  if (m_logger) {
+    m_logger->publish_staged(*internal::t_staging);
+  }
+}
+
+LogBatch Logger::begin_batch() {
+  thread_local StagingStorage staging_storage;
+
+  if (!internal::t_staging) {
+    staging_storage.buffer = std::make_unique<internal::StagingBuffer>();
+    internal::t_staging = staging_storage.buffer.get();
+  }
+
+  if (internal::t_staging->owner) {
+    return LogBatch(nullptr);
+  }
+
+  internal::t_staging->owner = this;
+  return LogBatch(this);
+}
+
+void Logger::publish_staged(internal::StagingBuffer& staging) {
+  if (staging.size == 0) {
+    return;
+  }
+
+  const auto thread = internal::current_thread_index();
+  if (!m_gate.try_enter(thread)) {
+    m_dropped.fetch_add(discard_staged(staging, 0), std::memory_order_relaxed);
+    staging.size = 0;
+    return;
+  }
+
+  // Whatever does not fit is dropped, as with single records.
+  size_t published = 0;
+  if (auto* queue = m_thread_queues ? m_thread_queues->local() : nullptr) {
+    published = queue->try_push_bulk(staging.payloads, staging.size);
+    if (published > 0 && queue->consumer_caught_up(published)) {
+      m_signal.notify();
+    }
+  } else {
+    published = m_queue->try_push_bulk(staging.payloads, staging.size);
+    if (published > 0) {
+      m_signal.notify();
+    }
+  }
+  if (published < staging.size) {
+    m_dropped.fetch_add(discard_staged(staging, published),
+                        std::memory_order_relaxed);
+  }
+  staging.size = 0;
+
+  m_gate.leave(thread);
+}
+
+// Tells the consumer about the calling thread's context ahead of its first
+// record under it.
+bool Logger::publish_context(internal::StagingBuffer* staging) {
+  auto& stack = internal::t_context;
+  auto text = std::make_unique<std::string>(stack.rendered);
+  const internal::ContextUpdate update{stack.version, text.get()};
+  if (staging) {
+    if (staging->size == internal::BATCH_CAPACITY) {
+      publish_staged(*staging);
+    }
+    staging->payloads[staging->size++] = internal::MessagePayload(update);
+  } else if (!enqueue(update)) {
+    return false;
+  }
+  text.release();
+  stack.published_to = m_generation;
+  stack.published_version = stack.version;
+  return true;
+}
+
+bool Logger::publish_shared(LogLevel level, std::string_view text) {
+  const auto thread = internal::current_thread_index();
+  if (!m_gate.try_enter(thread)) [[unlikely]] {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  const auto name = internal::thread_name(thread);
+  const bool written = m_shared_ring->try_write(
+      level, internal::MessagePayload::now_ns(), name.view(), text);
+  if (!written) {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  m_gate.leave(thread);
+  return written;
 }
 
 void Logger::shutdown() {
+  m_gate.close();
+
   m_done.store(true, std::memory_order_release);
-  m_signal.fetch_add(1, std::memory_order_release);
-  m_signal.notify_one();
+  m_signal.notify();
 
   if (m_consumer_thread.joinable()) {
     m_consumer_thread.join();
   }
 }
 
+void Logger::process(const internal::MessagePayload& payload,
+                     ConsumerContext& context) {
+  if (payload.is_context_update()) [[unlikely]] {
+    context.set_thread_context(payload);
+    return;
+  }
+
+  const bool sampled =
+      context.formatted++ % internal::METRICS_SAMPLE_PERIOD == 0;
+
+  const auto now = internal::MessagePayload::now_ns();
+  m_queue_latency.record(
+      static_cast<uint64_t>(std::max<int64_t>(0, now - payload.timestamp_ns)));
+
+  auto& chunk = context.current();
+
+  // Besides every METRICS_SAMPLE_PERIOD records, the depth is taken at the
+  // start of every chunk, i.e. right after the consumer ran dry or handed a
+  // full chunk to the sinks, which is where a burst piles up.
+  if (sampled || chunk.entries.empty()) {
+    const auto depth = (m_thread_queues ? m_thread_queues->last_depth()
+                                        : m_queue->size_approx()) +
+                       1;
+    if (depth > m_queue_high_water.load(std::memory_order_relaxed)) {
+      m_queue_high_water.store(depth, std::memory_order_relaxed);
+    }
+  }
+
+  std::chrono::steady_clock::time_point format_start;
+  if (sampled) {
+    format_start = std::chrono::steady_clock::now();
+  }
+
+  auto& bytes = chunk.bytes;
+  const auto offset = bytes.size();
+  append_prefix(bytes, context.timestamps, payload.timestamp_ns,
+                payload.level, payload.thread_index);
+  internal::append_sample_rate(bytes, payload.sample_rate);
+  if (payload.context != 0) {
+    if (const auto* rendered = context.thread_context(payload)) {
+      internal::append_context(bytes, *rendered);
+    }
+  }
+  payload.formatter(bytes, payload.format_string, payload.arg_buffer);
+  bytes.push_back('\n');
+  chunk.entries.push_back({static_cast<uint32_t>(offset),
+                           static_cast<uint32_t>(bytes.size() - offset),
+                           payload.level});
+
+  if (sampled) {
+    m_format_time.record(elapsed_ns(format_start));
+  }
+
+  if (bytes.size() >= ConsumerContext::CHUNK_BYTES) {
+    dispatch(context);
+  }
+}
+
+// Views are only built here: until the chunk is complete, appending may
+// still move its bytes.
+void Logger::dispatch(ConsumerContext& context) {
+  auto* chunk = context.chunk.get();
+  if (!chunk || chunk->entries.empty()) {
+    return;
+  }
+
+  chunk->views.clear();
+  for (const auto& entry : chunk->entries) {
+    chunk->views.push_back(
+        {std::string_view(chunk->bytes).substr(entry.offset, entry.size),
+         entry.level});
+  }
+
+  m_sink_set.load()->write_batch(RecordBatch(*chunk));
+  m_processed.fetch_add(chunk->entries.size(), std::memory_order_relaxed);
+  context.recycle();
+}
+
+void Logger::report_metrics(ConsumerContext& context) {
+  dispatch(context);
+
+  // The consumer cannot take m_sink_update_mutex: a writer holding it may be
+  // waiting for the consumer epoch to move.
+  const auto* sinks = m_sink_set.load();
+  const auto snapshot = snapshot_metrics(*sinks);
+
+  auto& buffer = context.buffer;
+  buffer.clear();
+  append_prefix(buffer, context.timestamps, internal::MessagePayload::now_ns(),
+                LOG_LEVEL_INFO, internal::current_thread_index());
+
+  auto out = std::back_inserter(buffer);
+  std::format_to(out,
+                 "logger metrics: processed={} dropped={} "
+                 "queue_high_water={}/{} queue_latency_ns(p50={} p99={} "
+                 "max={}) format_ns(p50={} p99={})",
+                 snapshot.records_processed, snapshot.records_dropped,
+                 snapshot.queue_high_water, snapshot.queue_capacity,
+                 snapshot.queue_latency_ns.percentile_ns(50),
+                 snapshot.queue_latency_ns.percentile_ns(99),
+                 snapshot.queue_latency_ns.max_ns,
+                 snapshot.format_ns.percentile_ns(50),
+                 snapshot.format_ns.percentile_ns(99));
+  for (const auto& sink : snapshot.sinks) {
+    std::format_to(out,
+                   "; sink {}: records={} bytes={} write_ns(p99={}) "
+                   "rotate_ns(count={} max={}) sync_ns(count={} p99={}) "
+                   "errors={}",
+                   sink.id, sink.records, sink.bytes,
+                   sink.write_ns.percentile_ns(99), sink.rotate_ns.count,
+                   sink.rotate_ns.max_ns, sink.sync_ns.count,
+                   sink.sync_ns.percentile_ns(99), sink.errors);
+  }
+  buffer.push_back('\n');
+
+  sinks->write(buffer, LOG_LEVEL_INFO);
+}
+
+// Per-thread queues first: the shared one only holds records from threads
+// the registry had no room for, which are not ordered anyway. It is popped
+// while the merge holds records back too, so its records skip the window.
+bool Logger::try_pop(internal::MessagePayload& payload, bool drain,
+                     std::chrono::nanoseconds& hold) {
+  hold = std::chrono::nanoseconds::zero();
+  if (m_thread_queues && m_thread_queues->pop(payload, drain, hold)) {
+    return true;
+  }
+  return m_queue && m_queue->try_pop(payload);
+}
+
 void Logger::consumer_thread_loop() {
-  std::string buffer;
+  set_thread_name("log_consumer");
+
+  auto& context = *m_consumer_context;
   internal::MessagePayload payload;
+  std::chrono::nanoseconds hold{};
+
+  using Clock = internal::WakeSignal::Clock;
+  const auto report_interval = m_config.metrics_report_interval;
+  const bool reporting = report_interval.count() > 0;
+  auto next_report =
+      reporting ? Clock::now() + report_interval : Clock::time_point::max();
 
   while (!m_done.load(std::memory_order_acquire)) {
-    if (m_queue.try_pop(payload)) {
-      buffer.clear();
-      std::format_to(std::back_inserter(buffer), "{}: ",
-                     to_string(payload.level));
-      payload.formatter(buffer, payload.format_string, payload.arg_buffer);
-      buffer.push_back('\n');
-
-      // Dispatch to all sinks
-      for (const auto& sink : m_sinks) {
-        sink->write(buffer, payload.level);
+    if (m_consumer_halt.load(std::memory_order_relaxed)) [[unlikely]] {
+      // The crash handler owns the queue from here on; the process is about
+      // to die. Records already formatted still go out the normal way.
+      dispatch(context);
+      m_consumer_halted.store(true, std::memory_order_release);
+      for (;;) {
+        std::this_thread::sleep_for(std::chrono::hours(1));
       }
-    } else {
-      auto current = m_signal.load(std::memory_order_acquire);
-      m_signal.wait(current, std::memory_order_acquire);
     }
-  }
 
-  // Drain the queue after shutdown signal
-  while (m_queue.try_pop(payload)) {
-    buffer.clear();
-    std::format_to(std::back_inserter(buffer), "{}: ",
-                   to_string(payload.level));
-    payload.formatter(buffer, payload.format_string, payload.arg_buffer);
-    buffer.push_back('\n');
-    for (const auto& sink : m_sinks) {
-      sink->write(buffer, payload.level);
+    // Take the ticket before polling so a push that lands in between is not
+    // slept through.
+    const auto ticket = m_signal.prepare();
+    const bool popped = try_pop(payload, false, hold);
+
+    if (popped) {
+      process(payload, context);
+    }
+
+    if (!popped) {
+      dispatch(context);
+    }
+
+    auto wake = next_report;
+    if (!popped ||
+        context.formatted % internal::METRICS_SAMPLE_PERIOD == 0) {
+      const auto now = Clock::now();
+      if (reporting && now >= next_report) {
+        report_metrics(context);
+        next_report = now + report_interval;
+      }
+      const auto* sinks = m_sink_set.load();
+      sinks->run_deadlines(now);
+      wake = std::min(next_report, sinks->deadline());
+    }
+    if (!popped && hold.count() > 0) {
+      // Records are waiting out the merge window.
+      wake = std::min(wake, Clock::now() + hold);
+    }
+
+    // Quiescent point: no sink set snapshot is held past here.
+    m_consumer_epoch.fetch_add(1);
+
+    if (!popped) {
+      m_signal.wait_until(ticket, wake);
     }
   }
 
-  // Flush all sinks
-  for (const auto& sink : m_sinks) {
-    sink->flush();
+  // Drain the queue after shutdown signal
+  while (try_pop(payload, true, hold)) {
+    process(payload, context);
   }
+  dispatch(context);
+
+  m_sink_set.load()->flush();
+  m_consumer_exited.store(true, std::memory_order_release);
 }
 
-}  // namespace log_library
\ No newline at end of file
+}  // namespace log_library
@@ -0,0 +1,103 @@
+#include "placement.h"
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <new>
+#include <system_error>
+
+namespace log_library::internal {
+
+#ifdef __linux__
+
+int place_current_thread(const LoggerConfig& config) {
+  if (!config.consumer_cpus.empty()) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (const int cpu : config.consumer_cpus) {
+      if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return EINVAL;
+      }
+      CPU_SET(cpu, &cpus);
+    }
+    if (::sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+      return errno;
+    }
+  }
+
+  if (config.consumer_idle_priority) {
+    const sched_param param{};
+    if (const int error =
+            ::pthread_setschedparam(::pthread_self(), SCHED_IDLE, &param)) {
+      return error;
+    }
+  } else if (config.consumer_nice != 0) {
+    // The nice value is per thread on Linux.
+    const auto tid = static_cast<id_t>(::syscall(SYS_gettid));
+    if (::setpriority(PRIO_PROCESS, tid, config.consumer_nice) != 0) {
+      return errno;
+    }
+  }
+  return 0;
+}
+
+void* allocate_on_node(size_t size, int numa_node) {
+  void* memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  if (numa_node < 0) {
+    return memory;
+  }
+
+  // Nothing is touched yet, so every page is faulted in on the node.
+  unsigned long mask[16] = {};
+  constexpr auto MASK_BITS = sizeof(mask) * 8;
+  int error = EINVAL;
+  if (static_cast<size_t>(numa_node) < MASK_BITS - 1) {
+    mask[numa_node / 64] = 1UL << (numa_node % 64);
+    error = ::syscall(SYS_mbind, memory, size, MPOL_BIND, mask, MASK_BITS,
+                      0) == 0
+                ? 0
+                : errno;
+  }
+  // A kernel without NUMA support has exactly one node.
+  if (error == ENOSYS && numa_node == 0) {
+    error = 0;
+  }
+  if (error != 0) {
+    ::munmap(memory, size);
+    throw std::system_error(error, std::system_category(),
+                            "Failed to bind log queue to NUMA node");
+  }
+  return memory;
+}
+
+void free_on_node(void* memory, size_t size) noexcept {
+  ::munmap(memory, size);
+}
+
+#else
+
+int place_current_thread(const LoggerConfig&) { return 0; }
+
+void* allocate_on_node(size_t size, int) {
+  return ::operator new(size, std::align_val_t{64});
+}
+
+void free_on_node(void* memory, size_t) noexcept {
+  ::operator delete(memory, std::align_val_t{64});
+}
+
+#endif
+
+}  // namespace log_library::internal
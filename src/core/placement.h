@@ -0,0 +1,18 @@
+#pragma once
+
+#include <log_library/logger_config.h>
+
+#include <cstddef>
+
+namespace log_library::internal {
+
+// Applies the consumer settings from `config` (affinity, scheduling policy,
+// nice value) to the calling thread. Returns 0 or an errno value.
+int place_current_thread(const LoggerConfig& config);
+
+// Page-aligned memory whose pages are bound to `numa_node` (-1: default
+// policy). Throws std::system_error if the binding is rejected.
+void* allocate_on_node(size_t size, int numa_node);
+void free_on_node(void* memory, size_t size) noexcept;
+
+}  // namespace log_library::internal
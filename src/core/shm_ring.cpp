@@ -0,0 +1,430 @@
+#include <log_library/internal/shm_ring.hpp>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+namespace log_library::internal {
+
+namespace {
+
+constexpr uint64_t RING_MAGIC = 0x31676e69726c6f67;  // "golring1"
+constexpr uint32_t RING_VERSION = 1;
+
+struct RecordHeader {
+  int64_t timestamp_ns;
+  uint32_t pid;
+  uint32_t text_size;
+  uint8_t level;
+  uint8_t name_size;
+  char name[ShmRing::MAX_THREAD_NAME + 1];
+};
+
+}  // namespace
+
+struct ShmRing::Header {
+  std::atomic<uint64_t> magic;
+  uint32_t version;
+  uint32_t slot_count;
+  alignas(64) std::atomic<uint64_t> head;
+  alignas(64) std::atomic<uint64_t> tail;
+  alignas(64) std::atomic<uint64_t> dropped;
+  std::atomic<uint64_t> abandoned;
+};
+
+struct alignas(64) ShmRing::Slot {
+  std::atomic<uint64_t> turn;
+  // Slots taken by the record starting here; 0 in continuation slots.
+  uint32_t record_slots;
+  uint32_t reserved;
+  char data[SLOT_SIZE - 16];
+};
+
+namespace {
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "process-shared atomics must be lock-free");
+
+constexpr size_t SLOT_DATA = ShmRing::SLOT_SIZE - 16;
+constexpr size_t FIRST_SLOT_TEXT = SLOT_DATA - sizeof(RecordHeader);
+constexpr size_t MAX_TEXT =
+    FIRST_SLOT_TEXT + (ShmRing::MAX_RECORD_SLOTS - 1) * SLOT_DATA;
+
+// The header gets a page of its own; slots start right after it.
+constexpr size_t HEADER_SIZE = 4096;
+
+// A slot's turn is the position it is free for, position + 1 once the
+// record in it is published, or position | TURN_WRITING while a producer
+// fills it. A slot the reader gave up on mid-write also gets
+// TURN_ABANDONED and is not reused until its producer lets go of it.
+constexpr uint64_t TURN_WRITING = 1ULL << 63;
+constexpr uint64_t TURN_ABANDONED = 1ULL << 62;
+constexpr uint64_t TURN_FLAGS = TURN_WRITING | TURN_ABANDONED;
+
+}  // namespace
+
+#ifndef _WIN32
+
+std::unique_ptr<ShmRing> ShmRing::open(const std::string& name,
+                                       size_t slot_count) {
+  static_assert(sizeof(Header) <= HEADER_SIZE);
+  static_assert(sizeof(Slot) == SLOT_SIZE);
+
+  slot_count = std::bit_ceil(std::max<size_t>(slot_count, MAX_RECORD_SLOTS));
+  const std::string path = name.starts_with('/') ? name : "/" + name;
+  const size_t offset = HEADER_SIZE;
+
+  int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd != -1) {
+    const size_t size = offset + slot_count * sizeof(Slot);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      ::close(fd);
+      shm_unlink(path.c_str());
+      throw std::runtime_error("Failed to size shared log ring");
+    }
+    void* mapping =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+      shm_unlink(path.c_str());
+      throw std::runtime_error("Failed to map shared log ring");
+    }
+
+    auto* header = new (mapping) Header{};
+    header->version = RING_VERSION;
+    header->slot_count = static_cast<uint32_t>(slot_count);
+    auto* slots = reinterpret_cast<Slot*>(static_cast<char*>(mapping) + offset);
+    for (size_t i = 0; i < slot_count; ++i) {
+      new (&slots[i]) Slot{};
+      slots[i].turn.store(i, std::memory_order_relaxed);
+    }
+    // Attachers spin on the magic, so it goes in last.
+    header->magic.store(RING_MAGIC, std::memory_order_release);
+    return std::unique_ptr<ShmRing>(new ShmRing(mapping, size));
+  }
+
+  if (errno != EEXIST) {
+    throw std::runtime_error("Failed to open shared log ring");
+  }
+  fd = shm_open(path.c_str(), O_RDWR, 0600);
+  if (fd == -1) {
+    throw std::runtime_error("Failed to open shared log ring");
+  }
+
+  // The creator may still be initializing the segment.
+  void* mapping = MAP_FAILED;
+  for (int attempt = 0; attempt < 1000; ++attempt) {
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) > offset) {
+      mapping = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     fd, 0);
+      if (mapping != MAP_FAILED) {
+        auto* header = static_cast<Header*>(mapping);
+        if (header->magic.load(std::memory_order_acquire) == RING_MAGIC) {
+          const size_t size =
+              offset + size_t{header->slot_count} * sizeof(Slot);
+          if (header->version != RING_VERSION ||
+              size != static_cast<size_t>(info.st_size)) {
+            munmap(mapping, info.st_size);
+            ::close(fd);
+            throw std::runtime_error("Incompatible shared log ring");
+          }
+          ::close(fd);
+          return std::unique_ptr<ShmRing>(new ShmRing(mapping, size));
+        }
+        munmap(mapping, info.st_size);
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  ::close(fd);
+  throw std::runtime_error("Timed out attaching to shared log ring");
+}
+
+void ShmRing::unlink(const std::string& name) {
+  const std::string path = name.starts_with('/') ? name : "/" + name;
+  shm_unlink(path.c_str());
+}
+
+ShmRing::ShmRing(void* mapping, size_t mapping_size)
+    : m_mapping(mapping),
+      m_mapping_size(mapping_size),
+      m_header(static_cast<Header*>(mapping)),
+      m_slots(reinterpret_cast<Slot*>(static_cast<char*>(mapping) +
+                                      HEADER_SIZE)),
+      m_mask(m_header->slot_count - 1),
+      m_pid(static_cast<uint32_t>(getpid())) {}
+
+ShmRing::~ShmRing() { munmap(m_mapping, m_mapping_size); }
+
+#else
+
+std::unique_ptr<ShmRing> ShmRing::open(const std::string&, size_t) {
+  throw std::runtime_error("Shared log rings are not supported on Windows");
+}
+
+void ShmRing::unlink(const std::string&) {}
+
+ShmRing::ShmRing(void* mapping, size_t mapping_size)
+    : m_mapping(mapping),
+      m_mapping_size(mapping_size),
+      m_header(nullptr),
+      m_slots(nullptr),
+      m_mask(0),
+      m_pid(0) {}
+
+ShmRing::~ShmRing() = default;
+
+#endif
+
+ShmRing::Slot& ShmRing::slot(uint64_t position) const noexcept {
+  return m_slots[position & m_mask];
+}
+
+size_t ShmRing::slot_count() const noexcept { return m_mask + 1; }
+
+uint64_t ShmRing::dropped() const noexcept {
+  return m_header->dropped.load(std::memory_order_relaxed);
+}
+
+uint64_t ShmRing::abandoned() const noexcept {
+  return m_header->abandoned.load(std::memory_order_relaxed);
+}
+
+bool ShmRing::try_write(LogLevel level, int64_t timestamp_ns,
+                        std::string_view thread_name,
+                        std::string_view text) noexcept {
+  const size_t text_size = std::min(text.size(), MAX_TEXT);
+  const size_t needed =
+      text_size <= FIRST_SLOT_TEXT
+          ? 1
+          : 1 + (text_size - FIRST_SLOT_TEXT + SLOT_DATA - 1) / SLOT_DATA;
+  const size_t capacity = slot_count();
+
+  auto head = m_header->head.load(std::memory_order_acquire);
+  for (;;) {
+    const auto tail = m_header->tail.load(std::memory_order_acquire);
+    if (tail > head) {
+      head = m_header->head.load(std::memory_order_acquire);
+      continue;
+    }
+    if (capacity - (head - tail) < needed) {
+      m_header->dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    if (m_header->head.compare_exchange_weak(head, head + needed,
+                                             std::memory_order_acq_rel)) {
+      break;
+    }
+  }
+
+  // Slots are claimed before they are written. One given up on in an
+  // earlier lap may still be held by its producer; then this record is
+  // dropped and the slots it did claim go out as empty continuations.
+  // A turn from an earlier lap without flags was released late and is free.
+  const auto claim = [&](uint64_t position) {
+    auto& turn = slot(position).turn;
+    auto current = turn.load(std::memory_order_acquire);
+    while ((current & TURN_FLAGS) == 0 && current <= position) {
+      if (turn.compare_exchange_weak(current, position | TURN_WRITING,
+                                     std::memory_order_acq_rel,
+                                     std::memory_order_acquire)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  // If the reader gave up on the slot meanwhile, nothing writes to it any
+  // more from here on, so it can be handed to the next lap.
+  const auto publish = [&](uint64_t position) {
+    auto& turn = slot(position).turn;
+    auto expected = position | TURN_WRITING;
+    if (turn.compare_exchange_strong(expected, position + 1,
+                                     std::memory_order_release,
+                                     std::memory_order_relaxed)) {
+      return true;
+    }
+    turn.store(position + capacity, std::memory_order_release);
+    return false;
+  };
+
+  uint32_t claimed = 0;
+  for (size_t i = 0; i < needed; ++i) {
+    if (claim(head + i)) {
+      claimed |= 1u << i;
+    }
+  }
+  if (claimed != (1u << needed) - 1) {
+    for (size_t i = 0; i < needed; ++i) {
+      if (claimed & (1u << i)) {
+        slot(head + i).record_slots = 0;
+        publish(head + i);
+      }
+    }
+    m_header->dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  Slot& first = slot(head);
+  first.record_slots = static_cast<uint32_t>(needed);
+
+  RecordHeader record{};
+  record.timestamp_ns = timestamp_ns;
+  record.pid = m_pid;
+  record.text_size = static_cast<uint32_t>(text_size);
+  record.level = static_cast<uint8_t>(level);
+  record.name_size =
+      static_cast<uint8_t>(std::min(thread_name.size(), MAX_THREAD_NAME));
+  std::memcpy(record.name, thread_name.data(), record.name_size);
+  std::memcpy(first.data, &record, sizeof(record));
+
+  size_t copied = std::min(text_size, FIRST_SLOT_TEXT);
+  std::memcpy(first.data + sizeof(record), text.data(), copied);
+  for (size_t i = 1; i < needed; ++i) {
+    Slot& next = slot(head + i);
+    next.record_slots = 0;
+    const size_t chunk = std::min(text_size - copied, SLOT_DATA);
+    std::memcpy(next.data, text.data() + copied, chunk);
+    copied += chunk;
+  }
+
+  bool published = true;
+  for (size_t i = 0; i < needed; ++i) {
+    published &= publish(head + i);
+  }
+  return published;
+}
+
+bool ShmRing::try_read(Record& record,
+                       std::chrono::nanoseconds stall_timeout) {
+  const size_t capacity = slot_count();
+
+  for (;;) {
+    const auto tail = m_header->tail.load(std::memory_order_relaxed);
+    const auto head = m_header->head.load(std::memory_order_acquire);
+    if (head == tail) {
+      return false;
+    }
+
+    // Gives up on an unpublished slot once it has been stuck for the whole
+    // stall timeout. Returns whether `position` was taken away from its
+    // producer. One not yet claimed is free for the next lap at once; one
+    // being written stays with its producer until it is done.
+    const auto abandon = [&](uint64_t position) {
+      const auto now = std::chrono::steady_clock::now();
+      if (position != m_stalled_position) {
+        m_stalled_position = position;
+        m_stalled_since = now;
+        return false;
+      }
+      if (now - m_stalled_since < stall_timeout) {
+        return false;
+      }
+      auto& turn = slot(position).turn;
+      auto expected = position;
+      if (turn.compare_exchange_strong(expected, position + capacity,
+                                       std::memory_order_acq_rel)) {
+        return true;
+      }
+      return expected == (position | TURN_WRITING) &&
+             turn.compare_exchange_strong(
+                 expected, position | TURN_WRITING | TURN_ABANDONED,
+                 std::memory_order_acq_rel);
+    };
+
+    Slot& first = slot(tail);
+    const auto turn = first.turn.load(std::memory_order_acquire);
+    if ((turn & ~TURN_FLAGS) < tail) {
+      // Left over from an earlier lap: still held by a producer given up
+      // on, or released by it after its lap had passed. Either way no
+      // record of this lap is in it.
+      auto expected = turn;
+      if ((turn & TURN_FLAGS) == 0 &&
+          !first.turn.compare_exchange_strong(expected, tail + capacity,
+                                              std::memory_order_acq_rel)) {
+        continue;
+      }
+      m_header->tail.store(tail + 1, std::memory_order_release);
+      continue;
+    }
+    if (turn != tail + 1) {
+      if (!abandon(tail)) {
+        return false;
+      }
+      m_header->abandoned.fetch_add(1, std::memory_order_relaxed);
+      m_header->tail.store(tail + 1, std::memory_order_release);
+      continue;
+    }
+
+    const size_t slots = first.record_slots;
+    if (slots == 0 || slots > MAX_RECORD_SLOTS) {
+      // Continuation of a record whose first slot was abandoned.
+      first.turn.store(tail + capacity, std::memory_order_release);
+      m_header->tail.store(tail + 1, std::memory_order_release);
+      continue;
+    }
+
+    for (size_t i = 1; i < slots; ++i) {
+      const auto position = tail + i;
+      if (slot(position).turn.load(std::memory_order_acquire) ==
+          position + 1) {
+        continue;
+      }
+      if (!abandon(position)) {
+        return false;
+      }
+      // Drop the partial record; later continuations are skipped as
+      // orphans once their producer publishes them.
+      for (size_t j = 0; j < i; ++j) {
+        slot(tail + j).turn.store(tail + j + capacity,
+                                  std::memory_order_release);
+      }
+      m_header->abandoned.fetch_add(1, std::memory_order_relaxed);
+      m_header->tail.store(position + 1, std::memory_order_release);
+      break;
+    }
+    if (m_header->tail.load(std::memory_order_relaxed) != tail) {
+      continue;
+    }
+
+    RecordHeader header;
+    std::memcpy(&header, first.data, sizeof(header));
+    const size_t text_size = std::min<size_t>(header.text_size, MAX_TEXT);
+    record.timestamp_ns = header.timestamp_ns;
+    record.pid = header.pid;
+    record.level = static_cast<LogLevel>(
+        std::min<uint8_t>(header.level, LOG_LEVEL_NONE));
+    record.thread_name.assign(
+        header.name, std::min<size_t>(header.name_size, MAX_THREAD_NAME));
+
+    record.text.clear();
+    size_t copied = std::min(text_size, FIRST_SLOT_TEXT);
+    record.text.append(first.data + sizeof(header), copied);
+    for (size_t i = 1; i < slots; ++i) {
+      const size_t chunk = std::min(text_size - copied, SLOT_DATA);
+      record.text.append(slot(tail + i).data, chunk);
+      copied += chunk;
+    }
+
+    for (size_t i = 0; i < slots; ++i) {
+      slot(tail + i).turn.store(tail + i + capacity, std::memory_order_release);
+    }
+    m_header->tail.store(tail + slots, std::memory_order_release);
+    m_stalled_position = UINT64_MAX;
+    return true;
+  }
+}
+
+}  // namespace log_library::internal
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <log_library/logger.h>
+#include <log_library/sink.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace log_library {
+
+// Immutable snapshot of a logger's sinks. The consumer only ever reads the
+// currently published one; updates build a new snapshot and swap it in.
+struct Logger::SinkSet {
+  // Consumer-side measurements, shared between snapshots so they survive
+  // unrelated sink set updates.
+  struct Stats {
+    std::atomic<uint64_t> records{0};
+    std::atomic<uint64_t> bytes{0};
+    internal::AtomicHistogram write_time;
+  };
+
+  struct Entry {
+    SinkId id;
+    std::shared_ptr<Sink> sink;
+    std::shared_ptr<Stats> stats;
+  };
+
+  std::vector<Entry> entries;
+
+  // Only the consumer writes the counters.
+  static void add(Stats& stats, uint64_t records, uint64_t bytes) {
+    stats.records.store(
+        stats.records.load(std::memory_order_relaxed) + records,
+        std::memory_order_relaxed);
+    stats.bytes.store(stats.bytes.load(std::memory_order_relaxed) + bytes,
+                      std::memory_order_relaxed);
+  }
+
+  // Single records written outside the batch path, such as metrics
+  // reports. Not timed.
+  void write(std::string_view message, LogLevel level) const {
+    for (const auto& entry : entries) {
+      entry.sink->write(message, level);
+      add(*entry.stats, 1, message.size());
+    }
+  }
+
+  void write_batch(const RecordBatch& batch) const {
+    for (const auto& entry : entries) {
+      const auto start = std::chrono::steady_clock::now();
+      entry.sink->write_batch(batch);
+      entry.stats->write_time.record(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count());
+      add(*entry.stats, batch.size(), batch.bytes());
+    }
+  }
+
+  std::chrono::steady_clock::time_point deadline() const {
+    auto earliest = std::chrono::steady_clock::time_point::max();
+    for (const auto& entry : entries) {
+      earliest = std::min(earliest, entry.sink->deadline());
+    }
+    return earliest;
+  }
+
+  void run_deadlines(std::chrono::steady_clock::time_point now) const {
+    for (const auto& entry : entries) {
+      if (entry.sink->deadline() <= now) {
+        entry.sink->on_deadline();
+      }
+    }
+  }
+
+  void flush() const {
+    for (const auto& entry : entries) {
+      entry.sink->flush();
+    }
+  }
+};
+
+}  // namespace log_library
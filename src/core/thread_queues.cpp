@@ -0,0 +1,95 @@
+#include <log_library/internal/thread_queues.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <new>
+
+namespace log_library::internal {
+
+ThreadQueues::ThreadQueues(size_t capacity, std::chrono::nanoseconds window)
+    : m_capacity(std::bit_ceil(capacity)),
+      m_window_ns(static_cast<uint64_t>(window.count())),
+      m_by_thread(std::make_unique<std::atomic<ThreadQueue*>[]>(MAX_THREADS)),
+      m_rings(std::make_unique<std::atomic<ThreadQueue*>[]>(MAX_THREADS)) {}
+
+// Only the thread that owns `thread` gets here for it, so the ring cannot
+// be created twice. Runs inside the producer gate, so it must not throw;
+// without a ring the thread falls back to the shared queue.
+ThreadQueue* ThreadQueues::create(ThreadIndex thread) {
+  std::lock_guard<std::mutex> lock(m_create_mutex);
+  ThreadQueue* queue = nullptr;
+  try {
+    queue =
+        m_owned.emplace_back(std::make_unique<ThreadQueue>(m_capacity)).get();
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+
+  const auto count = m_count.load(std::memory_order_relaxed);
+  m_rings[count].store(queue, std::memory_order_relaxed);
+  m_count.store(count + 1, std::memory_order_release);
+  m_by_thread[thread].store(queue, std::memory_order_release);
+  return queue;
+}
+
+bool ThreadQueues::pop(MessagePayload& value, bool drain,
+                       std::chrono::nanoseconds& hold) {
+  if (m_run) {
+    if (const auto* slot = m_run->front();
+        slot && slot->stamp <= m_run_bound) {
+      m_run->pop(value);
+      return true;
+    }
+    m_run = nullptr;
+  }
+
+  // Anything not yet published when the scan starts gets a stamp later
+  // than `now` minus the window, so that is as far as a run can go without
+  // looking at the other rings again, even ones that are empty now.
+  const auto now = static_cast<uint64_t>(MessagePayload::now_ns());
+  const auto settled = now > m_window_ns ? now - m_window_ns : 0;
+
+  // Lowest and second-lowest front stamp. Rings are few next to the
+  // records that go through them, so a linear scan beats keeping a heap
+  // up to date.
+  ThreadQueue* best = nullptr;
+  uint64_t best_stamp = std::numeric_limits<uint64_t>::max();
+  uint64_t second_stamp = best_stamp;
+  const auto count = m_count.load(std::memory_order_acquire);
+  // If everything looked empty, a second pass pairs with
+  // ThreadQueue::consumer_caught_up so that a record published meanwhile
+  // is either seen now or comes with a wake-up.
+  for (int pass = 0; pass < 2 && !best; ++pass) {
+    for (size_t i = 0; i < count; ++i) {
+      auto* ring = m_rings[i].load(std::memory_order_relaxed);
+      const auto* slot = pass == 0 ? ring->front() : ring->recheck();
+      if (!slot) {
+        continue;
+      }
+      if (slot->stamp < best_stamp) {
+        second_stamp = best_stamp;
+        best_stamp = slot->stamp;
+        best = ring;
+      } else if (slot->stamp < second_stamp) {
+        second_stamp = slot->stamp;
+      }
+    }
+  }
+
+  if (!best) {
+    hold = std::chrono::nanoseconds::zero();
+    return false;
+  }
+  if (!drain && best_stamp > settled && best_stamp <= now + m_window_ns) {
+    hold = std::chrono::nanoseconds(best_stamp - settled);
+    return false;
+  }
+
+  best->pop(value);
+  m_run = best;
+  m_run_bound = drain ? second_stamp : std::min(second_stamp, settled);
+  return true;
+}
+
+}  // namespace log_library::internal
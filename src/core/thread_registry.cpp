@@ -0,0 +1,171 @@
+#include <log_library/internal/thread_registry.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+namespace log_library::internal {
+
+namespace {
+
+constexpr size_t NAME_WORDS = (MAX_THREAD_NAME_LENGTH + 1) / sizeof(uint64_t);
+
+// Names are stored as whole words behind a per-slot sequence counter so the
+// consumer (or a signal handler) can copy them while the owning thread renames
+// itself, without locks and without racy plain-memory reads.
+struct ThreadSlot {
+  std::atomic<uint32_t> sequence{0};
+  std::atomic<uint32_t> os_tid{0};
+  std::atomic<uint64_t> name[NAME_WORDS]{};
+};
+
+ThreadSlot g_slots[MAX_THREADS];
+
+// Neither is ever destroyed: threads still exit during static destruction
+// (the default logger's consumer, for one) and give their slot back here.
+// The mutex is constant-initialized, so it is also usable before any
+// dynamic initialization has run.
+template <typename T>
+union Immortal {
+  constexpr Immortal() : value() {}
+  ~Immortal() {}
+  T value;
+};
+
+constinit Immortal<std::mutex> g_registry_mutex;
+size_t g_next_fresh_slot = 1;
+// Released indices are reused oldest-first so records still in flight for an
+// exited thread are unlikely to render under a new owner's name. Allocated
+// on first release, under g_registry_mutex.
+std::deque<ThreadIndex>* g_free_slots = nullptr;
+
+uint32_t current_os_thread_id() {
+#ifdef _WIN32
+  return static_cast<uint32_t>(GetCurrentThreadId());
+#else
+  return static_cast<uint32_t>(syscall(SYS_gettid));
+#endif
+}
+
+void store_name(ThreadSlot& slot, std::string_view name) {
+  uint64_t words[NAME_WORDS] = {};
+  std::memcpy(words, name.data(),
+              std::min(name.size(), MAX_THREAD_NAME_LENGTH));
+
+  const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+  slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < NAME_WORDS; ++i) {
+    slot.name[i].store(words[i], std::memory_order_relaxed);
+  }
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+struct ThreadSlotOwner {
+  ThreadIndex index = 0;
+
+  ~ThreadSlotOwner() {
+    if (index == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(g_registry_mutex.value);
+    if (!g_free_slots) {
+      g_free_slots = new std::deque<ThreadIndex>();
+    }
+    g_free_slots->push_back(index);
+  }
+};
+
+thread_local ThreadSlotOwner t_slot_owner;
+
+}  // namespace
+
+ThreadIndex register_current_thread() {
+  ThreadIndex index = 0;
+  {
+    std::lock_guard<std::mutex> lock(g_registry_mutex.value);
+    if (g_next_fresh_slot < MAX_THREADS) {
+      index = static_cast<ThreadIndex>(g_next_fresh_slot++);
+    } else if (g_free_slots && !g_free_slots->empty()) {
+      index = g_free_slots->front();
+      g_free_slots->pop_front();
+    }
+  }
+
+  if (auto* hook = g_on_thread_registered.load(std::memory_order_acquire)) {
+    hook();
+  }
+
+  if (index == 0) {
+    return 0;
+  }
+
+  auto& slot = g_slots[index];
+  const auto tid = current_os_thread_id();
+  slot.os_tid.store(tid, std::memory_order_relaxed);
+
+  char digits[16];
+  auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), tid);
+  store_name(slot, std::string_view(digits, end - digits));
+
+  t_slot_owner.index = index;
+  return index;
+}
+
+ThreadName thread_name(ThreadIndex index) noexcept {
+  ThreadName result{};
+
+  if (index == 0 || index >= MAX_THREADS) {
+    result.data[0] = '?';
+    result.size = 1;
+    return result;
+  }
+
+  const auto& slot = g_slots[index];
+  uint64_t words[NAME_WORDS];
+  uint32_t before;
+  uint32_t after;
+  do {
+    before = slot.sequence.load(std::memory_order_acquire);
+    for (size_t i = 0; i < NAME_WORDS; ++i) {
+      words[i] = slot.name[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = slot.sequence.load(std::memory_order_relaxed);
+  } while ((before & 1) != 0 || before != after);
+
+  std::memcpy(result.data, words, MAX_THREAD_NAME_LENGTH);
+  result.data[MAX_THREAD_NAME_LENGTH] = '\0';
+  result.size = std::strlen(result.data);
+  return result;
+}
+
+uint32_t thread_os_id(ThreadIndex index) noexcept {
+  if (index == 0 || index >= MAX_THREADS) {
+    return 0;
+  }
+  return g_slots[index].os_tid.load(std::memory_order_relaxed);
+}
+
+}  // namespace log_library::internal
+
+namespace log_library {
+
+void set_thread_name(std::string_view name) {
+  const auto index = internal::current_thread_index();
+  if (index == 0) {
+    return;
+  }
+  internal::store_name(internal::g_slots[index], name);
+}
+
+}  // namespace log_library
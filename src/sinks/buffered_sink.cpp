@@ -0,0 +1,141 @@
+#include <log_library/sinks/buffered_sink.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace log_library {
+
+namespace {
+
+ChunkRef make_chunk(size_t capacity) {
+  auto* chunk = new internal::RecordChunk;
+  chunk->bytes.reserve(capacity);
+  return ChunkRef::adopt(chunk);
+}
+
+}  // namespace
+
+BufferedSink::BufferedSink(std::unique_ptr<Sink> target,
+                           const BufferedSinkConfig& config)
+    : target_(std::move(target)), config_(config) {
+  if (!target_) {
+    throw std::invalid_argument("Buffered sink needs a target sink");
+  }
+  if (config_.buffer_bytes == 0) {
+    throw std::invalid_argument("Buffered sink buffer size must be non-zero");
+  }
+  // Room for the batch that crosses the threshold.
+  chunk_ = make_chunk(config_.buffer_bytes + 64 * 1024);
+}
+
+BufferedSink::~BufferedSink() { emit(); }
+
+void BufferedSink::write(std::string_view message, LogLevel level) {
+  append(message, level);
+  if (level >= config_.flush_level ||
+      chunk_.get()->bytes.size() >= config_.buffer_bytes) {
+    emit();
+  }
+}
+
+void BufferedSink::write_batch(const RecordBatch& batch) {
+  bool urgent = false;
+  for (const auto& record : batch.records()) {
+    append(record.text, record.level);
+    urgent |= record.level >= config_.flush_level;
+  }
+  if (urgent || chunk_.get()->bytes.size() >= config_.buffer_bytes) {
+    emit();
+  }
+}
+
+void BufferedSink::flush() {
+  emit();
+  target_->flush();
+}
+
+// The target's own deadline, if any, is passed through.
+std::chrono::steady_clock::time_point BufferedSink::deadline() const {
+  return std::min(deadline_, target_->deadline());
+}
+
+void BufferedSink::on_deadline() {
+  const auto now = std::chrono::steady_clock::now();
+  if (deadline_ <= now) {
+    emit();
+  }
+  if (target_->deadline() <= now) {
+    target_->on_deadline();
+  }
+}
+
+void BufferedSink::bind_wake_signal(internal::WakeSignal* signal) {
+  target_->bind_wake_signal(signal);
+}
+
+void BufferedSink::write_from_signal(std::string_view message,
+                                     LogLevel level) {
+  emit_from_signal();
+  target_->write_from_signal(message, level);
+}
+
+void BufferedSink::flush_from_signal() {
+  emit_from_signal();
+  target_->flush_from_signal();
+}
+
+void BufferedSink::collect_metrics(SinkMetrics& metrics) const {
+  target_->collect_metrics(metrics);
+}
+
+void BufferedSink::append(std::string_view message, LogLevel level) {
+  auto& chunk = *chunk_.get();
+  if (chunk.entries.empty()) {
+    deadline_ = std::chrono::steady_clock::now() + config_.max_delay;
+  }
+  const auto offset = static_cast<uint32_t>(chunk.bytes.size());
+  chunk.bytes.append(message);
+  chunk.entries.push_back(
+      {offset, static_cast<uint32_t>(message.size()), level});
+}
+
+void BufferedSink::emit() {
+  auto* chunk = chunk_.get();
+  if (chunk->entries.empty()) {
+    return;
+  }
+
+  chunk->views.clear();
+  for (const auto& entry : chunk->entries) {
+    chunk->views.push_back(
+        {std::string_view(chunk->bytes).substr(entry.offset, entry.size),
+         entry.level});
+  }
+  target_->write_batch(RecordBatch(*chunk));
+  deadline_ = std::chrono::steady_clock::time_point::max();
+
+  // A target that retained the chunk keeps it; start a new one.
+  if (chunk_.unique()) {
+    chunk->bytes.clear();
+    chunk->entries.clear();
+    chunk->views.clear();
+  } else {
+    chunk_ = make_chunk(chunk->bytes.capacity());
+  }
+}
+
+// Hands over what is buffered without allocating. The consumer may have
+// been stopped halfway through append(); entries are only added after
+// their bytes, so every listed record is complete.
+void BufferedSink::emit_from_signal() noexcept {
+  auto* chunk = chunk_.get();
+  for (const auto& entry : chunk->entries) {
+    target_->write_from_signal(
+        std::string_view(chunk->bytes).substr(entry.offset, entry.size),
+        entry.level);
+  }
+  chunk->entries.clear();
+}
+
+}  // namespace log_library
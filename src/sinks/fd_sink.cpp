@@ -0,0 +1,82 @@
+#include "fd_sink.h"
+
+#include <log_library/sinks/fd_sink.h>
+
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+
+namespace log_library {
+
+namespace {
+constexpr int MAX_IOV = IOV_MAX < 1024 ? IOV_MAX : 1024;
+}  // namespace
+
+FdSink::FdSink(int fd) : fd_(fd) {}
+
+void FdSink::write(std::string_view message, LogLevel level) {
+  iovec iov{const_cast<char*>(message.data()), message.size()};
+  write_all(&iov, 1);
+}
+
+// The batch is written straight from the consumer's chunk, MAX_IOV records
+// per system call.
+void FdSink::write_batch(const RecordBatch& batch) {
+  iovec iov[MAX_IOV];
+  int count = 0;
+  for (const auto& record : batch.records()) {
+    iov[count++] = {const_cast<char*>(record.text.data()), record.text.size()};
+    if (count == MAX_IOV) {
+      write_all(iov, count);
+      count = 0;
+    }
+  }
+  if (count > 0) {
+    write_all(iov, count);
+  }
+}
+
+void FdSink::flush() {}
+
+void FdSink::write_from_signal(std::string_view message, LogLevel level) {
+  iovec iov{const_cast<char*>(message.data()), message.size()};
+  write_all(&iov, 1);
+}
+
+void FdSink::collect_metrics(SinkMetrics& metrics) const {
+  metrics.errors = errors_.load(std::memory_order_relaxed);
+}
+
+// Retries short writes and EINTR; anything else drops the rest of the call.
+void FdSink::write_all(iovec* iov, int count) noexcept {
+  while (count > 0) {
+    const ssize_t written = ::writev(fd_, iov, count);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      errors_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    auto remaining = static_cast<size_t>(written);
+    while (count > 0 && remaining >= iov->iov_len) {
+      remaining -= iov->iov_len;
+      ++iov;
+      --count;
+    }
+    if (count > 0) {
+      iov->iov_base = static_cast<char*>(iov->iov_base) + remaining;
+      iov->iov_len -= remaining;
+    }
+  }
+}
+
+std::unique_ptr<Sink> create_fd_sink(int fd) {
+  return std::make_unique<FdSink>(fd);
+}
+
+}  // namespace log_library
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <log_library/sink.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+struct iovec;
+
+namespace log_library {
+
+class FdSink : public Sink {
+ public:
+  explicit FdSink(int fd);
+  void write(std::string_view message, LogLevel level) override;
+  void write_batch(const RecordBatch& batch) override;
+  void flush() override;
+  void write_from_signal(std::string_view message, LogLevel level) override;
+  void collect_metrics(SinkMetrics& metrics) const override;
+
+ private:
+  void write_all(iovec* iov, int count) noexcept;
+
+  int fd_;
+  std::atomic<uint64_t> errors_{0};
+};
+
+}  // namespace log_library
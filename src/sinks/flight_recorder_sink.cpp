@@ -0,0 +1,294 @@
+#include <log_library/sinks/flight_recorder_sink.h>
+
+#include <log_library/internal/wake_signal.hpp>
+
+#ifndef _WIN32
+#include <signal.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace log_library {
+
+namespace {
+
+struct RecordHeader {
+  uint32_t size;
+  uint32_t level;
+};
+
+constexpr std::string_view DUMP_END = "--- end of flight recorder dump ---\n";
+
+// Bumped by the dump signal; each recorder compares it with the last value
+// it acted on.
+std::atomic<uint32_t> g_signal_generation{0};
+
+// Consumers of the recorders listening for the dump signal, which the
+// handler wakes so the dump is taken even on an idle logger. Recorders
+// beyond the limit are dumped with their next record instead.
+constexpr int MAX_SIGNAL_WAKERS = 64;
+std::atomic<internal::WakeSignal*> g_signal_wakers[MAX_SIGNAL_WAKERS];
+
+int claim_signal_waker(internal::WakeSignal* signal) {
+  for (int i = 0; i < MAX_SIGNAL_WAKERS; ++i) {
+    internal::WakeSignal* expected = nullptr;
+    if (g_signal_wakers[i].compare_exchange_strong(expected, signal)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+#ifndef _WIN32
+// Whatever was installed for each dump signal before us, chained to.
+struct sigaction g_previous_actions[NSIG];
+std::once_flag g_installed[NSIG];
+
+void on_dump_signal(int signo, siginfo_t* info, void* context) {
+  g_signal_generation.fetch_add(1, std::memory_order_relaxed);
+  for (auto& waker : g_signal_wakers) {
+    if (auto* signal = waker.load(std::memory_order_acquire)) {
+      signal->notify();
+    }
+  }
+
+  const auto& previous = g_previous_actions[signo];
+  if (previous.sa_flags & SA_SIGINFO) {
+    previous.sa_sigaction(signo, info, context);
+  } else if (previous.sa_handler != SIG_DFL &&
+             previous.sa_handler != SIG_IGN) {
+    previous.sa_handler(signo);
+  }
+}
+
+void install_dump_signal(int signo) {
+  if (signo <= 0 || signo >= NSIG) {
+    throw std::invalid_argument("Invalid flight recorder dump signal");
+  }
+  std::call_once(g_installed[signo], [signo] {
+    struct sigaction action{};
+    action.sa_sigaction = on_dump_signal;
+    action.sa_flags = SA_RESTART | SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    sigaction(signo, &action, &g_previous_actions[signo]);
+  });
+}
+#endif
+
+}  // namespace
+
+FlightRecorderSink::FlightRecorderSink(std::unique_ptr<Sink> target,
+                                       const FlightRecorderConfig& config)
+    : target_(std::move(target)), config_(config) {
+  if (!target_) {
+    throw std::invalid_argument("Flight recorder needs a target sink");
+  }
+  if (config_.capacity_bytes <= sizeof(RecordHeader)) {
+    throw std::invalid_argument("Flight recorder capacity is too small");
+  }
+  arena_ = std::make_unique<char[]>(config_.capacity_bytes);
+
+  seen_signal_generation_ =
+      g_signal_generation.load(std::memory_order_relaxed);
+#ifndef _WIN32
+  if (config_.dump_signal != 0) {
+    install_dump_signal(config_.dump_signal);
+  }
+#endif
+}
+
+FlightRecorderSink::~FlightRecorderSink() {
+  if (signal_waker_ >= 0) {
+    g_signal_wakers[signal_waker_].store(nullptr, std::memory_order_release);
+  }
+}
+
+void FlightRecorderSink::write(std::string_view message, LogLevel level) {
+  append(message, level);
+
+  if (level >= config_.trigger_level) {
+    dump_requested_.store(false, std::memory_order_relaxed);
+    dump("trigger level");
+  } else if (dump_pending()) {
+    dump("requested");
+  }
+}
+
+void FlightRecorderSink::flush() {
+  if (dump_pending()) {
+    dump("requested");
+  }
+}
+
+// A pending dump is due right away.
+std::chrono::steady_clock::time_point FlightRecorderSink::deadline() const {
+  if (dump_requested_.load(std::memory_order_relaxed) || signal_pending()) {
+    return std::chrono::steady_clock::time_point::min();
+  }
+  return target_->deadline();
+}
+
+void FlightRecorderSink::on_deadline() {
+  if (dump_pending()) {
+    dump("requested");
+  }
+  if (target_->deadline() <= std::chrono::steady_clock::now()) {
+    target_->on_deadline();
+  }
+}
+
+void FlightRecorderSink::bind_wake_signal(internal::WakeSignal* signal) {
+  wake_.store(signal, std::memory_order_release);
+  target_->bind_wake_signal(signal);
+  if (config_.dump_signal == 0) {
+    return;
+  }
+  if (signal_waker_ >= 0) {
+    g_signal_wakers[signal_waker_].store(signal, std::memory_order_release);
+  } else {
+    signal_waker_ = claim_signal_waker(signal);
+  }
+}
+
+void FlightRecorderSink::write_from_signal(std::string_view message,
+                                           LogLevel level) {
+  append(message, level);
+}
+
+void FlightRecorderSink::flush_from_signal() { dump_from_signal(); }
+
+void FlightRecorderSink::collect_metrics(SinkMetrics& metrics) const {
+  target_->collect_metrics(metrics);
+}
+
+void FlightRecorderSink::request_dump() noexcept {
+  dump_requested_.store(true, std::memory_order_relaxed);
+  if (auto* signal = wake_.load(std::memory_order_acquire)) {
+    signal->notify();
+  }
+}
+
+bool FlightRecorderSink::signal_pending() const noexcept {
+  return config_.dump_signal != 0 &&
+         g_signal_generation.load(std::memory_order_relaxed) !=
+             seen_signal_generation_;
+}
+
+bool FlightRecorderSink::dump_pending() noexcept {
+  bool pending = dump_requested_.exchange(false, std::memory_order_relaxed);
+  if (signal_pending()) {
+    seen_signal_generation_ =
+        g_signal_generation.load(std::memory_order_relaxed);
+    pending = true;
+  }
+  return pending;
+}
+
+void FlightRecorderSink::append(std::string_view message,
+                                LogLevel level) noexcept {
+  const size_t size =
+      std::min(message.size(), config_.capacity_bytes - sizeof(RecordHeader));
+  const size_t needed = sizeof(RecordHeader) + size;
+  evict(needed);
+
+  const RecordHeader header{static_cast<uint32_t>(size),
+                            static_cast<uint32_t>(level)};
+  copy_in(head_, &header, sizeof(header));
+  copy_in(head_ + sizeof(header), message.data(), size);
+  head_ += needed;
+  ++record_count_;
+}
+
+void FlightRecorderSink::evict(size_t needed) noexcept {
+  uint64_t evicted = 0;
+  while (config_.capacity_bytes - (head_ - tail_) < needed) {
+    RecordHeader header;
+    copy_out(tail_, &header, sizeof(header));
+    tail_ += sizeof(header) + header.size;
+    --record_count_;
+    ++evicted;
+  }
+  if (evicted > 0) {
+    overwritten_.fetch_add(evicted, std::memory_order_relaxed);
+  }
+}
+
+void FlightRecorderSink::copy_in(uint64_t position, const void* data,
+                                 size_t size) noexcept {
+  const size_t offset = position % config_.capacity_bytes;
+  const size_t first = std::min(size, config_.capacity_bytes - offset);
+  std::memcpy(arena_.get() + offset, data, first);
+  std::memcpy(arena_.get(), static_cast<const char*>(data) + first,
+              size - first);
+}
+
+void FlightRecorderSink::copy_out(uint64_t position, void* out,
+                                  size_t size) const noexcept {
+  const size_t offset = position % config_.capacity_bytes;
+  const size_t first = std::min(size, config_.capacity_bytes - offset);
+  std::memcpy(out, arena_.get() + offset, first);
+  std::memcpy(static_cast<char*>(out) + first, arena_.get(), size - first);
+}
+
+void FlightRecorderSink::dump(std::string_view reason) {
+  scratch_.assign("--- flight recorder dump (");
+  scratch_.append(reason);
+  scratch_.append("): ");
+  scratch_.append(std::to_string(record_count_));
+  scratch_.append(" records, ");
+  scratch_.append(std::to_string(overwritten_count()));
+  scratch_.append(" overwritten so far ---\n");
+  target_->write(scratch_, LOG_LEVEL_WARN);
+
+  for (uint64_t position = tail_; position != head_;) {
+    RecordHeader header;
+    copy_out(position, &header, sizeof(header));
+    scratch_.resize(header.size);
+    copy_out(position + sizeof(header), scratch_.data(), header.size);
+    target_->write(scratch_, static_cast<LogLevel>(header.level));
+    position += sizeof(header) + header.size;
+  }
+
+  scratch_.assign(DUMP_END);
+  target_->write(scratch_, LOG_LEVEL_WARN);
+  target_->flush();
+
+  tail_ = head_;
+  record_count_ = 0;
+  dumps_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Same as dump() without allocating: records that wrap around the end of the
+// arena are handed over in two pieces.
+void FlightRecorderSink::dump_from_signal() noexcept {
+  target_->write_from_signal("--- flight recorder dump (crash) ---\n",
+                             LOG_LEVEL_WARN);
+
+  for (uint64_t position = tail_; position != head_;) {
+    RecordHeader header;
+    copy_out(position, &header, sizeof(header));
+    const auto level = static_cast<LogLevel>(header.level);
+
+    const size_t offset =
+        (position + sizeof(header)) % config_.capacity_bytes;
+    const size_t first =
+        std::min<size_t>(header.size, config_.capacity_bytes - offset);
+    target_->write_from_signal({arena_.get() + offset, first}, level);
+    if (first < header.size) {
+      target_->write_from_signal({arena_.get(), header.size - first}, level);
+    }
+    position += sizeof(header) + header.size;
+  }
+
+  target_->write_from_signal(DUMP_END, LOG_LEVEL_WARN);
+  target_->flush_from_signal();
+
+  tail_ = head_;
+  record_count_ = 0;
+  dumps_.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace log_library
@@ -1,17 +1,33 @@
 #include "linux_file_sink.h"
 
+#include <log_library/internal/segment_frame.hpp>
+
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <cerrno>
+#include <chrono>
 #include <cstring>
+#include <filesystem>
+#include <format>
 #include <stdexcept>
+#include <system_error>
 
 #include "file_rotation.h"
+#include "mapping_guard.h"
 
 namespace log_library {
 
+namespace {
+uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+}  // namespace
+
 LinuxFileSink::LinuxFileSink(const FileSinkConfig& config)
     : config_(config), fd_(-1), mapped_memory_(nullptr), current_offset_(0) {
   initialize();
@@ -19,27 +35,262 @@ LinuxFileSink::LinuxFileSink(const FileSinkConfig& config)
 
 LinuxFileSink::~LinuxFileSink() { cleanup(); }
 
-void LinuxFileSink::write(const std::string& message, LogLevel level) {
-  if (!mapped_memory_) {
+void LinuxFileSink::write(std::string_view message, LogLevel level) {
+  const RecordView record{message, level};
+  if (write_records({&record, 1}) && config_.fsync_on_error &&
+      !sync_to_disk()) {
+    enter_degraded("sync failed", last_error_);
+  }
+}
+
+// One sync for the whole batch instead of one per error record.
+void LinuxFileSink::write_batch(const RecordBatch& batch) {
+  if (write_records(batch.records()) && config_.fsync_on_error &&
+      !sync_to_disk()) {
+    enter_degraded("sync failed", last_error_);
+  }
+}
+
+std::chrono::steady_clock::time_point LinuxFileSink::deadline() const {
+  return next_retry_;
+}
+
+void LinuxFileSink::on_deadline() {
+  if (!degraded_) {
     return;
   }
+  if (!recover()) {
+    errors_.fetch_add(1, std::memory_order_relaxed);
+    next_retry_ = std::chrono::steady_clock::now() + config_.retry_interval;
+  }
+}
+
+// Every store into the mapping happens below this point, guarded against
+// SIGBUS. Returns whether an error record was written.
+bool LinuxFileSink::write_records(std::span<const RecordView> records) {
+  if (degraded_) {
+    spill(records);
+    return false;
+  }
+
+  batch_mapped_from_ = 0;
+  sigjmp_buf jump;
+  if (sigsetjmp(jump, 0) != 0) {
+    // Whatever part of the batch made it into the mapping is gone with the
+    // file's pages, so it is spilled. Records written before a rotation in
+    // this batch are in an earlier segment and stay there.
+    enter_degraded("SIGBUS writing to the mapping", EIO);
+    spill(records.subspan(batch_mapped_from_));
+    return false;
+  }
+  MappingGuard::arm(jump, &mapped_memory_, config_.max_file_size);
+  const bool error_written =
+      config_.framed ? append_framed(records) : append(records);
+  MappingGuard::disarm();
+  return error_written;
+}
+
+// Rotates if `size` more bytes for the batch's record at `index` do not fit
+// in the current segment. False if the record has to be dropped, or the
+// sink went degraded.
+bool LinuxFileSink::ensure_space(size_t size, size_t index) {
+  if (size > config_.max_file_size) {
+    errors_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  if (current_offset_ + size > config_.max_file_size) {
+    const auto start = std::chrono::steady_clock::now();
+    const bool rotated = rotate_file();
+    rotate_time_.record(elapsed_ns(start));
+    if (!rotated) {
+      enter_degraded("rotation failed", last_error_);
+      return false;
+    }
+    batch_mapped_from_ = index;
+  }
+  return true;
+}
 
-  if (current_offset_ + message.size() > config_.max_file_size) {
-    if (!rotate_file()) {
-      return;
+bool LinuxFileSink::append(std::span<const RecordView> records) {
+  bool error_written = false;
+  for (size_t i = 0; i < records.size(); ++i) {
+    const auto text = records[i].text;
+    if (!ensure_space(text.size(), i)) {
+      if (degraded_) {
+        spill(records.subspan(i));
+        break;
+      }
+      continue;
     }
+
+    std::memcpy(static_cast<char*>(mapped_memory_) + current_offset_,
+                text.data(), text.size());
+    current_offset_ += text.size();
+    error_written |= records[i].level >= LOG_LEVEL_ERROR;
   }
+  return error_written;
+}
 
-  std::memcpy(static_cast<char*>(mapped_memory_) + current_offset_,
-              message.data(), message.size());
-  current_offset_ += message.size();
+// Packs as many records per frame as fit in the current segment; the CRC
+// is taken while the record text is still in cache. Returns whether an
+// error record was written.
+bool LinuxFileSink::append_framed(std::span<const RecordView> records) {
+  bool error_written = false;
+  size_t next = 0;
+  while (next < records.size()) {
+    if (!ensure_space(
+            sizeof(internal::FrameHeader) + records[next].text.size(),
+            next)) {
+      if (degraded_) {
+        spill(records.subspan(next));
+        break;
+      }
+      ++next;
+      ++sequence_;
+      continue;
+    }
 
-  if (config_.fsync_on_error && level >= LOG_LEVEL_ERROR) {
-    sync_to_disk();
+    auto* base = static_cast<char*>(mapped_memory_);
+    const size_t frame = current_offset_;
+    size_t offset = frame + sizeof(internal::FrameHeader);
+    internal::FrameHeader header{internal::FRAME_MAGIC, 0, sequence_, 0, 0};
+    uint32_t crc = 0;
+    while (next < records.size() &&
+           offset + records[next].text.size() <= config_.max_file_size) {
+      const auto text = records[next].text;
+      std::memcpy(base + offset, text.data(), text.size());
+      crc = internal::crc32c(crc, text.data(), text.size());
+      offset += text.size();
+      error_written |= records[next].level >= LOG_LEVEL_ERROR;
+      ++header.records;
+      ++next;
+    }
+
+    header.size =
+        static_cast<uint32_t>(offset - frame - sizeof(internal::FrameHeader));
+    header.crc = internal::frame_crc(crc, header);
+    std::memcpy(base + frame, &header, sizeof(header));
+    current_offset_ = offset;
+    sequence_ += header.records;
   }
+  return error_written;
 }
 
-void LinuxFileSink::flush() { sync_to_disk(); }
+// Gives up on the current file without touching it again. Only the first
+// failure of an episode is kept as the reason.
+void LinuxFileSink::enter_degraded(std::string_view what, int error) {
+  errors_.fetch_add(1, std::memory_order_relaxed);
+  if (!degraded_) {
+    degraded_ = true;
+    degraded_reason_ = std::string(what) + ": " + std::strerror(error);
+  }
+  cleanup();
+  next_retry_ = std::chrono::steady_clock::now() + config_.retry_interval;
+}
+
+// Records that do not fit are only counted.
+void LinuxFileSink::spill(std::span<const RecordView> records) {
+  for (const auto& record : records) {
+    if (spill_.size() + record.text.size() > config_.spill_bytes) {
+      ++lost_;
+      continue;
+    }
+    spill_entries_.push_back({static_cast<uint32_t>(spill_.size()),
+                              static_cast<uint32_t>(record.text.size()),
+                              record.level});
+    spill_.append(record.text);
+  }
+}
+
+// Starts a fresh segment: the old one, if any, may be truncated or hold
+// pages that never reached the disk. Then writes the gap marker and the
+// spilled records.
+bool LinuxFileSink::recover() {
+  std::error_code error;
+  if (std::filesystem::exists(FileRotationUtils::get_current_log_path(config_),
+                              error) &&
+      !FileRotationUtils::rotate_log_files(config_)) {
+    return false;
+  }
+  FileRotationUtils::cleanup_old_files(config_);
+  if (!create_and_map_file()) {
+    return false;
+  }
+
+  degraded_ = false;
+  next_retry_ = std::chrono::steady_clock::time_point::max();
+  // Lost records still take sequence numbers, so framed readers see the
+  // gap too.
+  if (config_.framed) {
+    sequence_ += lost_;
+  }
+
+  const std::string marker = std::format(
+      "--- log gap: file unavailable ({}), {} records lost, {} held in "
+      "memory ---\n",
+      degraded_reason_, lost_, spill_entries_.size());
+  std::vector<RecordView> pending;
+  pending.reserve(spill_entries_.size() + 1);
+  pending.push_back({marker, LOG_LEVEL_WARN});
+
+  // Moved out first: if the file fails again, these are spilled anew.
+  const std::string spilled = std::move(spill_);
+  const auto entries = std::move(spill_entries_);
+  spill_.clear();
+  spill_entries_.clear();
+  lost_ = 0;
+  for (const auto& entry : entries) {
+    pending.push_back(
+        {std::string_view(spilled).substr(entry.offset, entry.size),
+         entry.level});
+  }
+  write_records(pending);
+  return true;
+}
+
+void LinuxFileSink::flush() {
+  if (!sync_to_disk()) {
+    enter_degraded("sync failed", last_error_);
+  }
+}
+
+// No rotation here: rotating allocates and touches the filesystem. Whatever
+// does not fit in the current mapping is lost.
+void LinuxFileSink::write_from_signal(std::string_view message,
+                                      LogLevel level) {
+  const size_t header_size =
+      config_.framed ? sizeof(internal::FrameHeader) : 0;
+  if (!mapped_memory_ || current_offset_ + header_size + message.size() >
+                             config_.max_file_size) {
+    return;
+  }
+
+  auto* base = static_cast<char*>(mapped_memory_);
+  if (config_.framed) {
+    internal::FrameHeader header{internal::FRAME_MAGIC,
+                                 static_cast<uint32_t>(message.size()),
+                                 sequence_++, 1, 0};
+    header.crc = internal::frame_crc(
+        internal::crc32c(0, message.data(), message.size()), header);
+    std::memcpy(base + current_offset_, &header, sizeof(header));
+  }
+  std::memcpy(base + current_offset_ + header_size, message.data(),
+              message.size());
+  current_offset_ += header_size + message.size();
+}
+
+void LinuxFileSink::flush_from_signal() {
+  if (!sync_to_disk()) {
+    errors_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void LinuxFileSink::collect_metrics(SinkMetrics& metrics) const {
+  metrics.rotate_ns = rotate_time_.snapshot();
+  metrics.sync_ns = sync_time_.snapshot();
+  metrics.errors = errors_.load(std::memory_order_relaxed);
+}
 
 void LinuxFileSink::initialize() {
   if (!FileRotationUtils::ensure_log_directory(config_)) {
@@ -56,12 +307,18 @@ bool LinuxFileSink::create_and_map_file() {
 
   fd_ = open(file_path.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
   if (fd_ == -1) {
+    last_error_ = errno;
     return false;
   }
 
-  if (posix_fallocate(fd_, 0, config_.max_file_size) != 0) {
+  // A file that could not be set up is removed again, so retries do not
+  // leave empty segments behind.
+  if (const int error = posix_fallocate(fd_, 0, config_.max_file_size);
+      error != 0) {
+    last_error_ = error;
     close(fd_);
     fd_ = -1;
+    unlink(file_path.c_str());
     return false;
   }
 
@@ -69,12 +326,15 @@ bool LinuxFileSink::create_and_map_file() {
       mmap(nullptr, config_.max_file_size, PROT_WRITE, MAP_SHARED, fd_, 0);
 
   if (mapped_memory_ == MAP_FAILED) {
+    last_error_ = errno;
     mapped_memory_ = nullptr;
     close(fd_);
     fd_ = -1;
+    unlink(file_path.c_str());
     return false;
   }
 
+  MappingGuard::install();
   current_offset_ = 0;
   return true;
 }
@@ -91,6 +351,7 @@ bool LinuxFileSink::rotate_file() {
   }
 
   if (!FileRotationUtils::rotate_log_files(config_)) {
+    last_error_ = EIO;
     return false;
   }
 
@@ -99,16 +360,23 @@ bool LinuxFileSink::rotate_file() {
   return create_and_map_file();
 }
 
-void LinuxFileSink::sync_to_disk() {
+bool LinuxFileSink::sync_to_disk() {
   if (!mapped_memory_) {
-    return;
+    return true;
   }
 
-  msync(mapped_memory_, current_offset_, MS_SYNC);
+  const auto start = std::chrono::steady_clock::now();
+  bool failed = msync(mapped_memory_, current_offset_, MS_SYNC) != 0;
 
   if (fd_ != -1) {
-    fsync(fd_);
+    failed |= fsync(fd_) != 0;
+  }
+  sync_time_.record(elapsed_ns(start));
+
+  if (failed) {
+    last_error_ = errno;
   }
+  return !failed;
 }
 
 void LinuxFileSink::cleanup() {
@@ -1,16 +1,31 @@
 #pragma once
 
 #include <log_library/file_sink_config.h>
+#include <log_library/internal/histogram.hpp>
 #include <log_library/sink.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
 namespace log_library {
 
 class LinuxFileSink : public Sink {
  public:
   explicit LinuxFileSink(const FileSinkConfig& config = {});
   ~LinuxFileSink() override;
-  void write(const std::string& message, LogLevel level) override;
+  void write(std::string_view message, LogLevel level) override;
+  void write_batch(const RecordBatch& batch) override;
   void flush() override;
+  std::chrono::steady_clock::time_point deadline() const override;
+  void on_deadline() override;
+  void write_from_signal(std::string_view message, LogLevel level) override;
+  void flush_from_signal() override;
+  void collect_metrics(SinkMetrics& metrics) const override;
 
  private:
   FileSinkConfig config_;
@@ -18,10 +33,38 @@ class LinuxFileSink : public Sink {
   void* mapped_memory_;
   size_t current_offset_;
 
+  internal::AtomicHistogram rotate_time_;
+  internal::AtomicHistogram sync_time_;
+  std::atomic<uint64_t> errors_{0};
+  // Next record's sequence number in framed mode.
+  uint64_t sequence_ = 0;
+  // errno of the last failed file operation.
+  int last_error_ = 0;
+
+  // Degraded mode: the file is unusable, records go to the spill buffer
+  // and recovery is retried at next_retry_.
+  bool degraded_ = false;
+  std::string degraded_reason_;
+  std::chrono::steady_clock::time_point next_retry_ =
+      std::chrono::steady_clock::time_point::max();
+  std::string spill_;
+  std::vector<internal::RecordChunk::Entry> spill_entries_;
+  uint64_t lost_ = 0;
+  // Index of the first record of the batch being written that went into
+  // the current segment; the ones before it are in earlier segments.
+  size_t batch_mapped_from_ = 0;
+
+  bool write_records(std::span<const RecordView> records);
+  bool ensure_space(size_t size, size_t index);
+  bool append(std::span<const RecordView> records);
+  bool append_framed(std::span<const RecordView> records);
+  void enter_degraded(std::string_view what, int error);
+  void spill(std::span<const RecordView> records);
+  bool recover();
   void initialize();
   bool create_and_map_file();
   bool rotate_file();
-  void sync_to_disk();
+  bool sync_to_disk();
   void cleanup();
 };
 
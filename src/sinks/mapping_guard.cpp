@@ -0,0 +1,104 @@
+#include "mapping_guard.h"
+
+#include <log_library/internal/thread_registry.hpp>
+
+#include <pthread.h>
+#include <signal.h>
+
+#include <mutex>
+
+namespace log_library {
+
+namespace {
+
+struct Armed {
+  sigjmp_buf* jump;
+  void* const* base;
+  size_t size;
+};
+
+thread_local Armed t_armed{nullptr, nullptr, 0};
+
+struct sigaction g_previous_action{};
+std::once_flag g_installed;
+std::mutex g_reinstall_mutex;
+
+void on_sigbus(int signo, siginfo_t* info, void* context) {
+  if (info) {
+    MappingGuard::try_recover(info->si_addr);
+  }
+
+  // Not ours. Returning re-executes the faulting access, which then hits
+  // the default action if there is no previous handler to take it.
+  if (g_previous_action.sa_flags & SA_SIGINFO) {
+    g_previous_action.sa_sigaction(signo, info, context);
+  } else if (g_previous_action.sa_handler != SIG_DFL &&
+             g_previous_action.sa_handler != SIG_IGN) {
+    g_previous_action.sa_handler(signo);
+  } else {
+    signal(signo, SIG_DFL);
+  }
+}
+
+bool installed() noexcept {
+  struct sigaction current{};
+  sigaction(SIGBUS, nullptr, &current);
+  return (current.sa_flags & SA_SIGINFO) && current.sa_sigaction == on_sigbus;
+}
+
+void put_in_front() noexcept {
+  // SA_NODEFER: the jump skips the signal mask restore, so SIGBUS must not
+  // be blocked while the handler runs.
+  struct sigaction action{};
+  action.sa_sigaction = on_sigbus;
+  action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_NODEFER;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGBUS, &action, &g_previous_action);
+}
+
+}  // namespace
+
+// Sinks map files from their own consumer threads. Unserialized, two of
+// them could both install the handler, and the second would then chain to
+// on_sigbus itself.
+void MappingGuard::install() noexcept {
+  internal::g_recover_mapping_fault.store(MappingGuard::try_recover,
+                                          std::memory_order_release);
+  std::call_once(g_installed, put_in_front);
+  if (installed()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(g_reinstall_mutex);
+  if (!installed()) {
+    put_in_front();
+  }
+}
+
+void MappingGuard::arm(sigjmp_buf& jump, void* const* base,
+                       size_t size) noexcept {
+  t_armed = {&jump, base, size};
+}
+
+void MappingGuard::disarm() noexcept { t_armed.jump = nullptr; }
+
+void MappingGuard::try_recover(const void* address) noexcept {
+  const Armed armed = t_armed;
+  if (!armed.jump) {
+    return;
+  }
+  const auto* fault = static_cast<const char*>(address);
+  const auto* base = static_cast<const char*>(*armed.base);
+  if (!base || fault < base || fault >= base + armed.size) {
+    return;
+  }
+  t_armed.jump = nullptr;
+  // The jump does not restore the signal mask, and a handler installed
+  // without SA_NODEFER left SIGBUS blocked.
+  sigset_t bus;
+  sigemptyset(&bus);
+  sigaddset(&bus, SIGBUS);
+  pthread_sigmask(SIG_UNBLOCK, &bus, nullptr);
+  siglongjmp(*armed.jump, 1);
+}
+
+}  // namespace log_library
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <setjmp.h>
+
+#include <cstddef>
+
+namespace log_library {
+
+// Turns a SIGBUS raised by a store into a file mapping (the file was
+// truncated underneath it, or the filesystem could not back the page) into
+// a jump back to the writer, instead of the death of the process:
+//
+//   sigjmp_buf jump;
+//   if (sigsetjmp(jump, 0) != 0) {
+//     // A store faulted; the guard is already disarmed.
+//   }
+//   MappingGuard::arm(jump, &base, size);
+//   ... stores into [base, base + size) ...
+//   MappingGuard::disarm();
+//
+// Nothing with a non-trivial destructor may live between sigsetjmp() and
+// the faulting store. A SIGBUS elsewhere, or on another thread, goes to the
+// handler that was installed before.
+class MappingGuard {
+ public:
+  // Installs the handler, or puts it back in front if something (such as
+  // the crash handler) has replaced it since. Thread-safe.
+  static void install() noexcept;
+
+  // `base` is read at fault time, so the mapping may be replaced while the
+  // guard is armed.
+  static void arm(sigjmp_buf& jump, void* const* base, size_t size) noexcept;
+  static void disarm() noexcept;
+
+  // Jumps back to this thread's armed writer if `address` lies in its
+  // mapping, and returns otherwise. For other SIGBUS handlers that end up
+  // in front of the guard's own, such as the crash handler.
+  static void try_recover(const void* address) noexcept;
+};
+
+}  // namespace log_library
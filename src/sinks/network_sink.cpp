@@ -0,0 +1,552 @@
+#include "network_sink.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+namespace log_library {
+
+namespace {
+
+constexpr size_t MAX_DATAGRAMS = 64;
+constexpr size_t MAX_IOV = IOV_MAX < 1024 ? IOV_MAX : 1024;
+constexpr size_t MAX_FRAMES = MAX_IOV / 2;
+
+// "2026-01-31T12:00:00.000000Z", as written by the consumer.
+constexpr size_t TIMESTAMP_SIZE = 27;
+
+constexpr std::string_view NEWLINE = "\n";
+
+// How often the retry buffer is offered to a socket that was full while no
+// new records come in to push it along.
+constexpr std::chrono::milliseconds RETRY_INTERVAL{10};
+
+int severity(LogLevel level) {
+  switch (level) {
+    case LOG_LEVEL_DEBUG:
+      return 7;
+    case LOG_LEVEL_INFO:
+      return 6;
+    case LOG_LEVEL_WARN:
+      return 4;
+    case LOG_LEVEL_ERROR:
+      return 3;
+    default:
+      return 5;
+  }
+}
+
+void append_number(std::string& out, uint64_t value) {
+  char digits[24];
+  const auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+  out.append(digits, end);
+}
+
+// Splits a formatted record into its timestamp ("-" if it has none, like
+// the flight recorder's dump banners) and the message after it, without
+// the trailing newline.
+std::pair<std::string_view, std::string_view> split_record(
+    std::string_view text) {
+  if (text.ends_with('\n')) {
+    text.remove_suffix(1);
+  }
+  if (text.size() > TIMESTAMP_SIZE && text[TIMESTAMP_SIZE] == ' ' &&
+      text[TIMESTAMP_SIZE - 1] == 'Z') {
+    return {text.substr(0, TIMESTAMP_SIZE), text.substr(TIMESTAMP_SIZE + 1)};
+  }
+  return {"-", text};
+}
+
+bool would_block(int error) { return error == EAGAIN || error == EWOULDBLOCK; }
+
+}  // namespace
+
+NetworkSink::NetworkSink(const NetworkSinkConfig& config,
+                         std::unique_ptr<Sink> fallback)
+    : config_(config), fallback_(std::move(fallback)) {
+  if (config_.format == NetworkFormat::Journald &&
+      config_.transport != NetworkTransport::UnixDatagram) {
+    throw std::invalid_argument("journald format needs a Unix socket");
+  }
+
+  const auto pid = static_cast<uint64_t>(::getpid());
+  if (config_.format == NetworkFormat::Journald) {
+    identity_ = "SYSLOG_IDENTIFIER=" + config_.app_name + "\nSYSLOG_FACILITY=";
+    append_number(identity_, static_cast<uint64_t>(config_.facility));
+    identity_ += "\nSYSLOG_PID=";
+    append_number(identity_, pid);
+    identity_ += "\nMESSAGE\n";
+  } else {
+    char host[256] = {};
+    if (::gethostname(host, sizeof(host) - 1) != 0 || host[0] == '\0') {
+      std::strcpy(host, "-");
+    }
+    identity_ = std::string(" ") + host + " " + config_.app_name + " ";
+    append_number(identity_, pid);
+    identity_ += " - - ";
+  }
+
+  if (config_.transport != NetworkTransport::UnixDatagram) {
+    resolve();
+  }
+  connect_socket();
+}
+
+NetworkSink::~NetworkSink() {
+  drain_pending(config_.flush_timeout);
+  // The socket already took the start of the first pending frame, so the
+  // remote has seen (part of) it; replaying it would duplicate it.
+  if (partial_ > 0 && !pending_empty()) {
+    ++pending_first_;
+    errors_.fetch_add(1, std::memory_order_relaxed);
+  }
+  // Whatever the remote never took is not lost.
+  to_fallback(pending_views());
+  clear_pending();
+  disconnect();
+  if (fallback_) {
+    fallback_->flush();
+  }
+}
+
+void NetworkSink::resolve() {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype =
+      config_.transport == NetworkTransport::Tcp ? SOCK_STREAM : SOCK_DGRAM;
+  hints.ai_flags = AI_NUMERICSERV;
+  addrinfo* results = nullptr;
+  const auto port = std::to_string(config_.port);
+  const int error =
+      ::getaddrinfo(config_.address.c_str(), port.c_str(), &hints, &results);
+  if (error != 0) {
+    throw std::runtime_error("Cannot resolve " + config_.address + ": " +
+                             ::gai_strerror(error));
+  }
+  for (auto* info = results; info; info = info->ai_next) {
+    Address address{info->ai_family, info->ai_socktype, info->ai_protocol,
+                    {}, info->ai_addrlen};
+    std::memcpy(&address.storage, info->ai_addr, info->ai_addrlen);
+    addresses_.push_back(address);
+  }
+  ::freeaddrinfo(results);
+}
+
+void NetworkSink::write(std::string_view message, LogLevel level) {
+  const RecordView record{message, level};
+  submit({&record, 1});
+}
+
+void NetworkSink::write_batch(const RecordBatch& batch) {
+  submit(batch.records());
+}
+
+// Only offers the retry buffer to the socket once; what it does not take
+// is retried on the deadline wake-up.
+void NetworkSink::flush() {
+  send_pending();
+  schedule_retry();
+  if (fallback_) {
+    fallback_->flush();
+  }
+}
+
+std::chrono::steady_clock::time_point NetworkSink::deadline() const {
+  return retry_at_;
+}
+
+void NetworkSink::on_deadline() {
+  send_pending();
+  schedule_retry();
+}
+
+void NetworkSink::write_from_signal(std::string_view message, LogLevel level) {
+  if (fallback_) {
+    fallback_->write_from_signal(message, level);
+  }
+}
+
+void NetworkSink::flush_from_signal() {
+  if (fallback_) {
+    fallback_->flush_from_signal();
+  }
+}
+
+void NetworkSink::collect_metrics(SinkMetrics& metrics) const {
+  metrics.errors = errors_.load(std::memory_order_relaxed);
+}
+
+// Older records always go first: the retry buffer is drained before the
+// new ones are sent, and only a sink with nothing pending sends straight
+// from the caller's memory.
+void NetworkSink::submit(std::span<const RecordView> records) {
+  if (!connected()) {
+    to_fallback(records);
+    return;
+  }
+
+  send_pending();
+  size_t sent = 0;
+  if (fd_ >= 0 && pending_empty()) {
+    sent = send_records(records);
+  }
+
+  if (fd_ < 0) {
+    to_fallback(records.subspan(sent));
+  } else {
+    enqueue(records.subspan(sent));
+  }
+  schedule_retry();
+}
+
+bool NetworkSink::connected() {
+  if (fd_ >= 0) {
+    return true;
+  }
+  if (std::chrono::steady_clock::now() < next_attempt_) {
+    return false;
+  }
+  return connect_socket();
+}
+
+bool NetworkSink::connect_socket() {
+  int fd = -1;
+  if (config_.transport == NetworkTransport::UnixDatagram) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (config_.address.size() < sizeof(address.sun_path)) {
+      std::memcpy(address.sun_path, config_.address.c_str(),
+                  config_.address.size() + 1);
+      fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+      if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address),
+                               sizeof(address)) != 0) {
+        ::close(fd);
+        fd = -1;
+      }
+    }
+  } else {
+    const bool stream = config_.transport == NetworkTransport::Tcp;
+    for (const auto& address : addresses_) {
+      fd = ::socket(address.family,
+                    address.socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                    address.protocol);
+      if (fd < 0) {
+        continue;
+      }
+      // A TCP connect completes in the background; until then sends
+      // report EAGAIN and records wait in the retry buffer.
+      if (::connect(fd, reinterpret_cast<const sockaddr*>(&address.storage),
+                    address.size) != 0 &&
+          !(stream && errno == EINPROGRESS)) {
+        ::close(fd);
+        fd = -1;
+        continue;
+      }
+      break;
+    }
+  }
+
+  if (fd < 0) {
+    errors_.fetch_add(1, std::memory_order_relaxed);
+    next_attempt_ = std::chrono::steady_clock::now() + config_.reconnect_interval;
+    return false;
+  }
+  fd_ = fd;
+  partial_ = 0;
+  return true;
+}
+
+void NetworkSink::disconnect() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+    next_attempt_ =
+        std::chrono::steady_clock::now() + config_.reconnect_interval;
+  }
+  partial_ = 0;
+}
+
+// Returns how many leading records the socket took in full. Stops early
+// when the socket is full or has failed (fd_ is then closed).
+size_t NetworkSink::send_records(std::span<const RecordView> records) {
+  if (config_.transport == NetworkTransport::Tcp) {
+    return send_stream(records);
+  }
+  return send_datagrams(records);
+}
+
+size_t NetworkSink::send_datagrams(std::span<const RecordView> records) {
+  const bool journald = config_.format == NetworkFormat::Journald;
+  size_t sent = 0;
+  while (sent < records.size()) {
+    const size_t count = std::min(records.size() - sent, MAX_DATAGRAMS);
+    encode(records.subspan(sent, count));
+
+    mmsghdr messages[MAX_DATAGRAMS];
+    iovec iov[MAX_DATAGRAMS][3];
+    for (size_t i = 0; i < count; ++i) {
+      const auto head = header(i);
+      iov[i][0] = {const_cast<char*>(head.data()), head.size()};
+      iov[i][1] = {const_cast<char*>(bodies_[i].data()), bodies_[i].size()};
+      iov[i][2] = {const_cast<char*>(NEWLINE.data()), NEWLINE.size()};
+      messages[i] = {};
+      messages[i].msg_hdr.msg_iov = iov[i];
+      messages[i].msg_hdr.msg_iovlen = journald ? 3 : 2;
+    }
+
+    const int result = ::sendmmsg(fd_, messages, static_cast<unsigned>(count),
+                                  MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (would_block(errno) || errno == ENOBUFS) {
+        return sent;
+      }
+      errors_.fetch_add(1, std::memory_order_relaxed);
+      if (errno == EMSGSIZE) {
+        // Too large for any datagram; retrying would not help.
+        ++sent;
+        continue;
+      }
+      disconnect();
+      return sent;
+    }
+    sent += static_cast<size_t>(result);
+  }
+  return sent;
+}
+
+size_t NetworkSink::send_stream(std::span<const RecordView> records) {
+  size_t sent = 0;
+  while (sent < records.size()) {
+    const size_t count = std::min(records.size() - sent, MAX_FRAMES);
+    encode(records.subspan(sent, count));
+
+    iovec iov[MAX_IOV];
+    size_t iov_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+      const auto head = header(i);
+      iov[iov_count++] = {const_cast<char*>(head.data()), head.size()};
+      iov[iov_count++] = {const_cast<char*>(bodies_[i].data()),
+                          bodies_[i].size()};
+    }
+
+    // Resume the frame the previous call left half-written.
+    size_t first = 0;
+    for (size_t skip = partial_; skip > 0; ++first) {
+      if (skip < iov[first].iov_len) {
+        iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + skip;
+        iov[first].iov_len -= skip;
+        break;
+      }
+      skip -= iov[first].iov_len;
+    }
+
+    msghdr message{};
+    message.msg_iov = iov + first;
+    message.msg_iovlen = iov_count - first;
+    const ssize_t written =
+        ::sendmsg(fd_, &message, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (!would_block(errno)) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        disconnect();
+      }
+      return sent;
+    }
+
+    auto taken = partial_ + static_cast<size_t>(written);
+    for (size_t i = 0; i < count; ++i) {
+      const size_t frame = header(i).size() + bodies_[i].size();
+      if (taken < frame) {
+        break;
+      }
+      taken -= frame;
+      ++sent;
+    }
+    partial_ = taken;
+  }
+  return sent;
+}
+
+// Builds the header of every record into scratch_. On the wire each header
+// is followed by bodies_[i] (and a newline for journald).
+void NetworkSink::encode(std::span<const RecordView> records) {
+  scratch_.clear();
+  header_ends_.clear();
+  bodies_.clear();
+
+  for (const auto& record : records) {
+    const auto [timestamp, body] = split_record(record.text);
+    const size_t start = scratch_.size();
+
+    if (config_.format == NetworkFormat::Journald) {
+      scratch_ += "PRIORITY=";
+      append_number(scratch_, static_cast<uint64_t>(severity(record.level)));
+      scratch_ += '\n';
+      scratch_ += identity_;
+      // Binary field: the message may contain newlines.
+      uint64_t size = body.size();
+      for (int i = 0; i < 8; ++i, size >>= 8) {
+        scratch_ += static_cast<char>(size & 0xff);
+      }
+    } else {
+      scratch_ += '<';
+      append_number(scratch_,
+                    static_cast<uint64_t>(config_.facility * 8 +
+                                          severity(record.level)));
+      scratch_ += ">1 ";
+      scratch_ += timestamp;
+      scratch_ += identity_;
+      if (config_.transport == NetworkTransport::Tcp) {
+        // Octet counting: "MSG-LEN SP SYSLOG-MSG".
+        char digits[24];
+        auto [end, ec] =
+            std::to_chars(digits, digits + sizeof(digits) - 1,
+                          scratch_.size() - start + body.size());
+        *end++ = ' ';
+        scratch_.insert(start, digits, static_cast<size_t>(end - digits));
+      }
+    }
+
+    header_ends_.push_back(scratch_.size());
+    bodies_.push_back(body);
+  }
+}
+
+std::string_view NetworkSink::header(size_t index) const {
+  const size_t begin = index == 0 ? 0 : header_ends_[index - 1];
+  return std::string_view(scratch_).substr(begin,
+                                           header_ends_[index] - begin);
+}
+
+void NetworkSink::send_pending() {
+  if (pending_empty()) {
+    return;
+  }
+  const auto records = pending_views();
+  const size_t sent = send_records(records);
+  if (fd_ < 0) {
+    to_fallback(records.subspan(sent));
+    clear_pending();
+    return;
+  }
+  pending_first_ += sent;
+  if (pending_empty()) {
+    clear_pending();
+  }
+}
+
+// Waits up to `timeout` for the socket to take the retry buffer.
+void NetworkSink::drain_pending(std::chrono::milliseconds timeout) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (fd_ >= 0 && !pending_empty()) {
+    send_pending();
+    if (fd_ < 0 || pending_empty()) {
+      break;
+    }
+    const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    pollfd descriptor{fd_, POLLOUT, 0};
+    if (left.count() <= 0 ||
+        ::poll(&descriptor, 1, static_cast<int>(left.count())) <= 0) {
+      break;
+    }
+  }
+}
+
+void NetworkSink::schedule_retry() {
+  retry_at_ = pending_empty()
+                  ? std::chrono::steady_clock::time_point::max()
+                  : std::chrono::steady_clock::now() + RETRY_INTERVAL;
+}
+
+std::span<const RecordView> NetworkSink::pending_views() {
+  pending_views_.clear();
+  for (size_t i = pending_first_; i < pending_.size(); ++i) {
+    pending_views_.push_back(
+        {std::string_view(pending_bytes_)
+             .substr(pending_[i].offset, pending_[i].size),
+         pending_[i].level});
+  }
+  return pending_views_;
+}
+
+// Copies records into the retry buffer. Once one does not fit, it and
+// everything after it in this call go to the fallback, so each destination
+// still sees records in order. A record the socket took only part of is
+// kept whatever its size: the rest of it must follow on the stream.
+void NetworkSink::enqueue(std::span<const RecordView> records) {
+  if (records.empty()) {
+    return;
+  }
+
+  if (pending_first_ > 0 && pending_first_ * 2 >= pending_.size()) {
+    const uint32_t dead = pending_[pending_first_].offset;
+    pending_bytes_.erase(0, dead);
+    pending_.erase(pending_.begin(),
+                   pending_.begin() + static_cast<ptrdiff_t>(pending_first_));
+    for (auto& entry : pending_) {
+      entry.offset -= dead;
+    }
+    pending_first_ = 0;
+  }
+
+  const bool half_sent = partial_ > 0 && pending_empty();
+  size_t queued = 0;
+  for (const auto& record : records) {
+    if (pending_bytes_.size() + record.text.size() >
+            config_.retry_buffer_bytes &&
+        !(half_sent && queued == 0)) {
+      break;
+    }
+    pending_.push_back({static_cast<uint32_t>(pending_bytes_.size()),
+                        static_cast<uint32_t>(record.text.size()),
+                        record.level});
+    pending_bytes_ += record.text;
+    ++queued;
+  }
+  to_fallback(records.subspan(queued));
+}
+
+void NetworkSink::clear_pending() {
+  pending_bytes_.clear();
+  pending_.clear();
+  pending_first_ = 0;
+  partial_ = 0;
+}
+
+void NetworkSink::to_fallback(std::span<const RecordView> records) {
+  if (records.empty()) {
+    return;
+  }
+  if (!fallback_) {
+    errors_.fetch_add(records.size(), std::memory_order_relaxed);
+    return;
+  }
+  for (const auto& record : records) {
+    fallback_->write(record.text, record.level);
+  }
+}
+
+std::unique_ptr<Sink> create_network_sink(const NetworkSinkConfig& config,
+                                          std::unique_ptr<Sink> fallback) {
+  return std::make_unique<NetworkSink>(config, std::move(fallback));
+}
+
+}  // namespace log_library
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <log_library/sink.h>
+#include <log_library/sinks/network_sink.h>
+
+#include <sys/socket.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace log_library {
+
+class NetworkSink : public Sink {
+ public:
+  NetworkSink(const NetworkSinkConfig& config, std::unique_ptr<Sink> fallback);
+  ~NetworkSink() override;
+  void write(std::string_view message, LogLevel level) override;
+  void write_batch(const RecordBatch& batch) override;
+  void flush() override;
+  std::chrono::steady_clock::time_point deadline() const override;
+  void on_deadline() override;
+  void write_from_signal(std::string_view message, LogLevel level) override;
+  void flush_from_signal() override;
+  void collect_metrics(SinkMetrics& metrics) const override;
+
+ private:
+  struct Address {
+    int family;
+    int socktype;
+    int protocol;
+    sockaddr_storage storage;
+    socklen_t size;
+  };
+
+  struct Pending {
+    uint32_t offset;
+    uint32_t size;
+    LogLevel level;
+  };
+
+  void resolve();
+  void submit(std::span<const RecordView> records);
+  bool connected();
+  bool connect_socket();
+  void disconnect();
+  size_t send_records(std::span<const RecordView> records);
+  size_t send_datagrams(std::span<const RecordView> records);
+  size_t send_stream(std::span<const RecordView> records);
+  void encode(std::span<const RecordView> records);
+  std::string_view header(size_t index) const;
+  void send_pending();
+  void drain_pending(std::chrono::milliseconds timeout);
+  void schedule_retry();
+  bool pending_empty() const { return pending_first_ == pending_.size(); }
+  std::span<const RecordView> pending_views();
+  void enqueue(std::span<const RecordView> records);
+  void clear_pending();
+  void to_fallback(std::span<const RecordView> records);
+
+  NetworkSinkConfig config_;
+  std::unique_ptr<Sink> fallback_;
+  // Where to connect for UDP and TCP, resolved once up front so that a
+  // reconnect does not block the consumer on DNS.
+  std::vector<Address> addresses_;
+  int fd_ = -1;
+  std::chrono::steady_clock::time_point next_attempt_;
+  // When the consumer next offers the retry buffer to the socket.
+  std::chrono::steady_clock::time_point retry_at_ =
+      std::chrono::steady_clock::time_point::max();
+
+  // " HOSTNAME APP-NAME PROCID - - " for syslog, the constant fields for
+  // journald.
+  std::string identity_;
+
+  // Headers of the records being sent; each is followed on the wire by the
+  // record text itself, straight from the caller's memory.
+  std::string scratch_;
+  std::vector<size_t> header_ends_;
+  std::vector<std::string_view> bodies_;
+  // Bytes of the first pending TCP frame the socket already took.
+  size_t partial_ = 0;
+
+  // Retry buffer: records the socket would not take yet, oldest first.
+  std::string pending_bytes_;
+  std::vector<Pending> pending_;
+  size_t pending_first_ = 0;
+  std::vector<RecordView> pending_views_;
+
+  std::atomic<uint64_t> errors_{0};
+};
+
+}  // namespace log_library
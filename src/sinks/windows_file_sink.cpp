@@ -19,7 +19,7 @@ WindowsFileSink::~WindowsFileSink() {
   cleanup();
 }
 
-void WindowsFileSink::write(const std::string& message, LogLevel level) {
+void WindowsFileSink::write(std::string_view message, LogLevel level) {
   if (file_handle_ == INVALID_HANDLE_VALUE) {
     return;
   }
@@ -13,7 +13,7 @@ class WindowsFileSink : public Sink {
  public:
   explicit WindowsFileSink(const FileSinkConfig& config = {});
   ~WindowsFileSink() override;
-  void write(const std::string& message, LogLevel level) override;
+  void write(std::string_view message, LogLevel level) override;
   void flush() override;
 
  private:
@@ -0,0 +1,124 @@
+#include <log_library/logger.h>
+#include <log_library/sinks/buffered_sink.h>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+struct Received {
+  std::mutex mtx;
+  std::vector<std::string> lines;
+  std::atomic<size_t> batches{0};
+  std::atomic<size_t> records{0};
+};
+
+class CountingSink : public log_library::Sink {
+ public:
+  explicit CountingSink(Received& received) : received_(received) {}
+
+  void write(std::string_view message, LogLevel level) override {
+    std::lock_guard<std::mutex> lock(received_.mtx);
+    received_.lines.emplace_back(message);
+    received_.records.fetch_add(1);
+  }
+
+  void write_batch(const log_library::RecordBatch& batch) override {
+    {
+      std::lock_guard<std::mutex> lock(received_.mtx);
+      for (const auto& record : batch.records()) {
+        received_.lines.emplace_back(record.text);
+      }
+    }
+    received_.records.fetch_add(batch.size());
+    received_.batches.fetch_add(1);
+  }
+
+  void flush() override {}
+
+ private:
+  Received& received_;
+};
+
+template <typename Predicate>
+bool wait_for(Predicate done, std::chrono::milliseconds timeout) {
+  const auto until = std::chrono::steady_clock::now() + timeout;
+  while (!done()) {
+    if (std::chrono::steady_clock::now() > until) {
+      return false;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+
+std::unique_ptr<log_library::Logger> make_logger(
+    Received& received, const log_library::BufferedSinkConfig& config) {
+  std::vector<std::unique_ptr<log_library::Sink>> sinks;
+  sinks.push_back(std::make_unique<log_library::BufferedSink>(
+      std::make_unique<CountingSink>(received), config));
+  return std::make_unique<log_library::Logger>(std::move(sinks));
+}
+
+int main() {
+  constexpr int MESSAGES = 5000;
+
+  // The deadline: an idle consumer still hands records on within
+  // max_delay, without a flush or shutdown.
+  {
+    Received received;
+    log_library::BufferedSinkConfig config;
+    config.max_delay = 50ms;
+    auto logger = make_logger(received, config);
+    logger->push_log(LOG_LEVEL_INFO, "lonely record");
+    std::this_thread::sleep_for(10ms);
+    assert(received.records == 0);
+    assert(wait_for([&] { return received.records == 1; }, 2000ms));
+  }
+
+  // Size: with a long delay, only a full buffer moves records on, in few
+  // batches and in order.
+  {
+    Received received;
+    log_library::BufferedSinkConfig config;
+    config.buffer_bytes = 16 * 1024;
+    config.max_delay = 1h;
+    auto logger = make_logger(received, config);
+    for (int i = 0; i < MESSAGES; ++i) {
+      while (!logger->push_log(LOG_LEVEL_INFO, "record {}", i)) {
+        std::this_thread::yield();
+      }
+    }
+    assert(wait_for([&] { return received.records > 0; }, 2000ms));
+    logger->shutdown();
+
+    assert(received.records == MESSAGES);
+    assert(received.batches < MESSAGES / 20);
+    for (int i = 0; i < MESSAGES; ++i) {
+      assert(received.lines[i].ends_with(std::format("]: record {}\n", i)));
+    }
+  }
+
+  // Level: an ERROR goes out at once, together with what preceded it.
+  {
+    Received received;
+    log_library::BufferedSinkConfig config;
+    config.max_delay = 1h;
+    auto logger = make_logger(received, config);
+    logger->push_log(LOG_LEVEL_INFO, "context");
+    logger->push_log(LOG_LEVEL_ERROR, "failure");
+    assert(wait_for([&] { return received.records == 2; }, 2000ms));
+    assert(received.batches == 1);
+  }
+
+  std::cout << "Buffered sink test passed." << std::endl;
+  return 0;
+}
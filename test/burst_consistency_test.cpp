@@ -8,19 +8,18 @@
 #include <mutex>
 #include <regex>
 #include <set>
-#include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
 
 class VerifyingSink : public log_library::Sink {
  public:
-  void write(const std::string& message, LogLevel level) override {
+  void write(std::string_view message, LogLevel level) override {
     std::lock_guard<std::mutex> lock(mtx_);
     if (!message.empty() && message.back() == '\n') {
-      messages_.push_back(message.substr(0, message.length() - 1));
+      messages_.emplace_back(message.substr(0, message.length() - 1));
     } else {
-      messages_.push_back(message);
+      messages_.emplace_back(message);
     }
   }
 
@@ -59,23 +58,35 @@ struct std::formatter<TestPayload> : std::formatter<std::string> {
 };
 
 void simple_producer() {
+  log_library::set_thread_name("simple");
   for (int i = 0; i < MESSAGES_PER_BURST; ++i) {
     log_library::log_info("Simple producer #{}: payload={}", i, i);
   }
 }
 
 void struct_producer() {
+  log_library::set_thread_name("struct");
   for (int i = 0; i < MESSAGES_PER_BURST; ++i) {
     TestPayload p = {i, i + 1, i + 2};
     log_library::log_warn("Struct producer #{}: content={}", i, p);
   }
 }
 
-std::thread::id extract_thread_id(const std::string& msg) {
-  std::stringstream ss(msg);
-  unsigned long long id_val;
-  ss >> id_val;
-  return std::thread::id(id_val);
+void batched_producer() {
+  log_library::set_thread_name("batched");
+  auto batch = log_library::default_logger()->begin_batch();
+  for (int i = 0; i < MESSAGES_PER_BURST; ++i) {
+    log_library::log_info("Batched producer #{}: payload={}", i, i);
+  }
+}
+
+std::string extract_thread_name(const std::string& msg) {
+  const auto open = msg.find('[');
+  const auto close = msg.find(']', open);
+  if (open == std::string::npos || close == std::string::npos) {
+    return {};
+  }
+  return msg.substr(open + 1, close - open - 1);
 }
 
 int main() {
@@ -95,15 +106,14 @@ int main() {
 
     std::thread simple_thread(simple_producer);
     std::thread struct_thread(struct_producer);
-
-    auto simple_thread_id = simple_thread.get_id();
-    auto struct_thread_id = struct_thread.get_id();
+    std::thread batched_thread(batched_producer);
 
     simple_thread.join();
     struct_thread.join();
+    batched_thread.join();
 
     std::cout << "Producer burst finished. Total messages attempted: "
-              << MESSAGES_PER_BURST * 2 << std::endl;
+              << MESSAGES_PER_BURST * 3 << std::endl;
 
     std::this_thread::sleep_for(std::chrono::milliseconds(250));
 
@@ -118,16 +128,20 @@ int main() {
     std::set<int> seen_struct_indices;
     int simple_msgs_verified = 0;
     int struct_msgs_verified = 0;
+    int batched_msgs_verified = 0;
+    int last_batched_index = -1;
 
     const std::regex simple_regex(R"(Simple producer #(\d+): payload=(\d+))");
+    const std::regex batched_regex(
+        R"(Batched producer #(\d+): payload=(\d+))");
     const std::regex struct_regex(
         R"(Struct producer #(\d+): content=\[(\d+), (\d+), (\d+)\])");
     std::smatch match;
 
     for (const auto& msg : messages) {
-      auto thread_id = extract_thread_id(msg);
+      auto thread_name = extract_thread_name(msg);
 
-      if (thread_id == simple_thread_id) {
+      if (thread_name == "simple") {
         assert(std::regex_search(msg, match, simple_regex) &&
                "Simple message format is incorrect.");
         assert(match.size() == 3);
@@ -144,7 +158,7 @@ int main() {
         seen_simple_indices.insert(msg_index);
         simple_msgs_verified++;
 
-      } else if (thread_id == struct_thread_id) {
+      } else if (thread_name == "struct") {
         assert(std::regex_search(msg, match, struct_regex) &&
                "Struct message format is incorrect.");
         assert(match.size() == 5);
@@ -165,14 +179,36 @@ int main() {
                "Duplicate struct message detected!");
         seen_struct_indices.insert(msg_index);
         struct_msgs_verified++;
+
+      } else if (thread_name == "batched") {
+        assert(std::regex_search(msg, match, batched_regex) &&
+               "Batched message format is incorrect.");
+        assert(match.size() == 3);
+
+        int msg_index = std::stoi(match[1].str());
+        int payload_val = std::stoi(match[2].str());
+
+        assert(msg_index == payload_val &&
+               "Data corruption in batched message!");
+        assert(msg_index > last_batched_index &&
+               "Batched messages were reordered or duplicated!");
+        last_batched_index = msg_index;
+        batched_msgs_verified++;
       }
     }
 
+    assert(simple_msgs_verified + struct_msgs_verified +
+                   batched_msgs_verified ==
+               static_cast<int>(consumed_count) &&
+           "Record attributed to an unknown thread!");
+
     std::cout << "Data integrity verification complete." << std::endl;
     std::cout << "  - Verified " << simple_msgs_verified
               << " simple messages (no corruption or duplicates)." << std::endl;
     std::cout << "  - Verified " << struct_msgs_verified
               << " struct messages (no corruption or duplicates)." << std::endl;
+    std::cout << "  - Verified " << batched_msgs_verified
+              << " batched messages (in order, no corruption)." << std::endl;
   }
 
   if (auto* logger = log_library::default_logger(); logger) {
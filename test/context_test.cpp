@@ -0,0 +1,125 @@
+#include <log_library/context.h>
+#include <log_library/logger.h>
+#include <log_library/sink.h>
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_sinks.h"
+
+bool has(const std::vector<std::string>& lines, std::string_view text) {
+  for (const auto& line : lines) {
+    if (line.find(text) != std::string::npos) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int main() {
+  std::vector<std::string> lines;
+  std::mutex mtx;
+
+  {
+    std::vector<std::unique_ptr<log_library::Sink>> sinks;
+    sinks.push_back(std::make_unique<CollectingSink>(lines, mtx));
+    log_library::Logger logger(std::move(sinks));
+
+    logger.push_log(LOG_LEVEL_INFO, "before");
+    {
+      auto req = log_library::scoped_context("req", 42);
+      logger.push_log(LOG_LEVEL_INFO, "outer");
+      {
+        auto session = log_library::scoped_context("session", "abc");
+        logger.push_log(LOG_LEVEL_INFO, "inner {}", 1);
+      }
+      logger.push_log(LOG_LEVEL_INFO, "outer again");
+    }
+    logger.push_log(LOG_LEVEL_INFO, "after");
+
+    // Each thread has its own context, including on the batch path.
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+      workers.emplace_back([&logger, t] {
+        auto batch = logger.begin_batch();
+        for (int i = 0; i < 200; ++i) {
+          auto req = log_library::scoped_context("req", t * 1000 + i);
+          logger.push_log(LOG_LEVEL_INFO, "work {} {}", t, i);
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+
+    // Context updates lost to a full queue are sent again with the next
+    // record instead of leaving later records without their context.
+    CollectingSink::hold = true;
+    for (int i = 0; i < 3000; ++i) {
+      auto req = log_library::scoped_context("flood", i);
+      logger.push_log(LOG_LEVEL_INFO, "flood {}", i);
+    }
+    CollectingSink::hold = false;
+    auto late = log_library::scoped_context("late", true);
+    while (!logger.push_log(LOG_LEVEL_INFO, "late record")) {
+      std::this_thread::yield();
+    }
+  }
+
+  assert(has(lines, "]: before"));
+  assert(has(lines, "]: {req=42} outer\n"));
+  assert(has(lines, "]: {req=42 session=abc} inner 1\n"));
+  assert(has(lines, "]: {req=42} outer again\n"));
+  assert(has(lines, "]: after"));
+  // Records may have been dropped, but every one that arrived must carry
+  // the context it was logged under.
+  size_t work = 0;
+  size_t flood = 0;
+  for (const auto& line : lines) {
+    int t = 0;
+    int i = 0;
+    const char* message = line.c_str() + line.find("]: ") + 3;
+    if (std::sscanf(message, "{req=%*d} work %d %d", &t, &i) == 2) {
+      assert(line.ends_with(
+          std::format("]: {{req={}}} work {} {}\n", t * 1000 + i, t, i)));
+      ++work;
+    } else if (line.find(" flood ") != std::string::npos) {
+      i = std::atoi(line.c_str() + line.rfind(' ') + 1);
+      assert(line.ends_with(std::format("]: {{flood={}}} flood {}\n", i, i)));
+      ++flood;
+    }
+  }
+  assert(work > 0 && flood > 0);
+  assert(has(lines, "]: {late=true} late record\n"));
+
+  // A logger built where a destroyed one was still gets the context the
+  // thread had already sent to its predecessor.
+  lines.clear();
+  {
+    auto kept = log_library::scoped_context("kept", 7);
+    std::optional<log_library::Logger> logger;
+    for (int round = 0; round < 2; ++round) {
+      std::vector<std::unique_ptr<log_library::Sink>> sinks;
+      sinks.push_back(std::make_unique<CollectingSink>(lines, mtx));
+      logger.emplace(std::move(sinks));
+      logger->push_log(LOG_LEVEL_INFO, "round {}", round);
+      logger.reset();
+    }
+  }
+  assert(has(lines, "]: {kept=7} round 0\n"));
+  assert(has(lines, "]: {kept=7} round 1\n"));
+
+  std::cout << "Context test passed: " << work << " worker and " << flood
+            << " flood records." << std::endl;
+  return 0;
+}
@@ -0,0 +1,88 @@
+#include <log_library/internal/fast_format.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <string_view>
+
+using log_library::internal::format_fast;
+
+int checked = 0;
+
+// The fast path must append exactly what std::format produces.
+template <typename... Args>
+void check(std::format_string<Args...> fmt, const Args&... args) {
+  std::string out = "prefix ";
+  assert(format_fast(out, fmt.get(), args...));
+  assert(out == "prefix " +
+                    std::vformat(fmt.get(), std::make_format_args(args...)));
+  ++checked;
+}
+
+template <typename T>
+void check_limits() {
+  check("{}", std::numeric_limits<T>::min());
+  check("{}", std::numeric_limits<T>::max());
+  check("{}", T{0});
+}
+
+int main() {
+  check_limits<signed char>();
+  check_limits<unsigned char>();
+  check_limits<short>();
+  check_limits<unsigned short>();
+  check_limits<int>();
+  check_limits<unsigned>();
+  check_limits<long long>();
+  check_limits<unsigned long long>();
+
+  std::mt19937_64 rng(42);
+  for (int i = 0; i < 100000; ++i) {
+    const uint64_t bits = rng();
+    // Spread magnitudes across every digit count.
+    const uint64_t value = bits >> (bits % 64);
+    check("{} {}", value, static_cast<int64_t>(bits));
+    check("{}", static_cast<int32_t>(value));
+
+    double d;
+    static_assert(sizeof(d) == sizeof(bits));
+    std::memcpy(&d, &bits, sizeof(d));
+    if (!std::isnan(d)) {
+      check("{} {}", d, static_cast<float>(d));
+    }
+  }
+
+  check("{} {} {} {}", 0.0, -0.0, 1e300, 5e-324);
+  check("{} {} {}", std::numeric_limits<double>::infinity(),
+        -std::numeric_limits<double>::infinity(),
+        std::numeric_limits<double>::quiet_NaN());
+  check("{} {}", std::numeric_limits<float>::denorm_min(),
+        std::numeric_limits<float>::max());
+
+  int local = 0;
+  check("{} {} {}", static_cast<const void*>(&local),
+        static_cast<void*>(nullptr), nullptr);
+
+  const char* text = "text";
+  check("{} {} {} {}", text, std::string_view("view"), 'c', true);
+  check("{{literal}} {} }}{{ {}", false, 7);
+  check("no fields");
+  check("extra arguments are ignored", 1, 2);
+
+  // Anything beyond "{}" is left to std::vformat_to, with `out` untouched.
+  for (std::string_view fmt : {"{:>4}", "{0}", "{} {}", "{", "}", "x {:x}"}) {
+    std::string out = "prefix ";
+    assert(!format_fast(out, fmt, 255));
+    assert(out == "prefix ");
+  }
+
+  std::cout << "Fast format test passed: " << checked << " comparisons."
+            << std::endl;
+  return 0;
+}
@@ -0,0 +1,160 @@
+#include <log_library/crash_handler.h>
+#include <log_library/sinks/file_sink.h>
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+std::string read_file(const fs::path& path) {
+  std::ifstream in(path, std::ios::binary);
+  std::string text{std::istreambuf_iterator<char>(in),
+                   std::istreambuf_iterator<char>()};
+  return text.substr(0, text.find('\0'));
+}
+
+size_t count_files(const fs::path& dir) {
+  return std::distance(fs::directory_iterator(dir), fs::directory_iterator());
+}
+
+void set_file_size_limit(rlim_t limit) {
+  rlimit value{};
+  getrlimit(RLIMIT_FSIZE, &value);
+  value.rlim_cur = limit;
+  setrlimit(RLIMIT_FSIZE, &value);
+}
+
+uint64_t errors(const log_library::Sink& sink) {
+  log_library::SinkMetrics metrics;
+  sink.collect_metrics(metrics);
+  return metrics.errors;
+}
+
+int main() {
+  const fs::path dir =
+      fs::temp_directory_path() / std::format("degraded_test_{}", getpid());
+  fs::remove_all(dir);
+
+  log_library::FileSinkConfig config;
+  config.log_directory = dir.string() + "/";
+  config.max_file_size = 64 * 1024;
+  config.spill_bytes = 8 * 1024;
+  config.retry_interval = std::chrono::milliseconds(20);
+  config.fsync_on_error = false;
+
+  // Rotation fails: the next segment cannot be allocated. Stand-in for a
+  // full disk, without needing one.
+  {
+    auto sink = log_library::create_file_sink(config);
+    const std::string record(100, 'x');
+    for (int i = 0; i < 600; ++i) {
+      sink->write(record + "\n", LOG_LEVEL_INFO);
+    }
+    assert(sink->deadline() == Clock::time_point::max());
+
+    signal(SIGXFSZ, SIG_IGN);
+    const rlim_t limit = 16 * 1024;
+    set_file_size_limit(limit);
+    for (int i = 0; i < 2000; ++i) {
+      sink->write(std::format("spilled {}\n", i), LOG_LEVEL_INFO);
+    }
+    assert(sink->deadline() != Clock::time_point::max());
+    assert(errors(*sink) > 0);
+    const auto files = count_files(dir);
+
+    // Retries only happen when the deadline fires, and failed ones leave
+    // no empty segments behind.
+    std::this_thread::sleep_until(sink->deadline());
+    const auto failed_errors = errors(*sink);
+    sink->on_deadline();
+    assert(errors(*sink) > failed_errors);
+    assert(sink->deadline() > Clock::now());
+    assert(count_files(dir) == files);
+
+    set_file_size_limit(RLIM_INFINITY);
+    std::this_thread::sleep_until(sink->deadline());
+    sink->on_deadline();
+    assert(sink->deadline() == Clock::time_point::max());
+    sink->write("after recovery\n", LOG_LEVEL_INFO);
+    sink->flush();
+
+    const auto text = read_file(dir / "app.log");
+    assert(text.starts_with(
+        "--- log gap: file unavailable (rotation failed: "));
+    assert(text.find(" records lost, ") != std::string::npos);
+    assert(text.find(", 0 records lost, ") == std::string::npos);
+    // The spill picks up right where the old segment ended and holds the
+    // oldest records; the rest were counted as lost.
+    const auto first = text.substr(text.find('\n') + 1);
+    int resumed = -1;
+    assert(std::sscanf(first.c_str(), "spilled %d", &resumed) == 1);
+    assert(resumed > 0);
+    assert(read_file(dir / "app.log.1")
+               .ends_with(std::format("spilled {}\n", resumed - 1)));
+    assert(text.find("\nspilled 1999\n") == std::string::npos);
+    assert(text.ends_with("after recovery\n"));
+  }
+
+  // The file is truncated under the mapping: the store faults with SIGBUS,
+  // which the sink survives.
+  fs::remove_all(dir);
+  {
+    auto sink = log_library::create_file_sink(config);
+    sink->write("before truncation\n", LOG_LEVEL_INFO);
+    fs::resize_file(dir / "app.log", 0);
+    sink->write("during truncation\n", LOG_LEVEL_INFO);
+    assert(sink->deadline() != Clock::time_point::max());
+
+    std::this_thread::sleep_until(sink->deadline());
+    sink->on_deadline();
+    assert(sink->deadline() == Clock::time_point::max());
+    sink->flush();
+
+    const auto text = read_file(dir / "app.log");
+    assert(text.starts_with(
+        "--- log gap: file unavailable (SIGBUS writing to the mapping: "));
+    assert(text.ends_with("1 held in memory ---\nduring truncation\n"));
+  }
+
+  // The same, with the crash handler installed after the file was mapped and
+  // so in front of the sink's SIGBUS handler: it hands the fault back.
+  fs::remove_all(dir);
+  {
+    auto sink = log_library::create_file_sink(config);
+    sink->write("before truncation\n", LOG_LEVEL_INFO);
+    log_library::install_crash_handler();
+    for (int round = 0; round < 2; ++round) {
+      // The second round faults again: SIGBUS was not left blocked.
+      fs::resize_file(dir / "app.log", 0);
+      sink->write(std::format("truncated {}\n", round), LOG_LEVEL_INFO);
+      assert(sink->deadline() != Clock::time_point::max());
+
+      std::this_thread::sleep_until(sink->deadline());
+      sink->on_deadline();
+      assert(sink->deadline() == Clock::time_point::max());
+      sink->flush();
+
+      const auto text = read_file(dir / "app.log");
+      assert(text.starts_with(
+          "--- log gap: file unavailable (SIGBUS writing to the mapping: "));
+      assert(text.ends_with(std::format("truncated {}\n", round)));
+    }
+  }
+
+  fs::remove_all(dir);
+  std::cout << "Degraded file sink test passed." << std::endl;
+  return 0;
+}
@@ -0,0 +1,122 @@
+#include <log_library/logger.h>
+#include <log_library/sink.h>
+#include <log_library/sinks/flight_recorder_sink.h>
+
+#include <signal.h>
+
+#include <atomic>
+#include <cassert>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_sinks.h"
+
+void wait_for_consumer(const log_library::Logger& logger, uint64_t records) {
+  while (logger.metrics().records_processed < records) {
+    std::this_thread::yield();
+  }
+}
+
+void wait_for_dumps(const log_library::FlightRecorderSink& flight,
+                    uint64_t dumps) {
+  while (flight.dump_count() < dumps) {
+    std::this_thread::yield();
+  }
+}
+
+std::atomic<int> g_previous_handler_calls{0};
+
+int main() {
+  std::vector<std::string> lines;
+  std::mutex mtx;
+
+  // Someone else's handler for the dump signal.
+  signal(SIGUSR2, [](int) { ++g_previous_handler_calls; });
+
+  log_library::FlightRecorderConfig config;
+  config.capacity_bytes = 4096;
+  config.dump_signal = SIGUSR2;
+  auto recorder = std::make_unique<log_library::FlightRecorderSink>(
+      std::make_unique<CollectingSink>(lines, mtx), config);
+  auto* flight = recorder.get();
+
+  std::vector<std::unique_ptr<log_library::Sink>> sinks;
+  sinks.push_back(std::move(recorder));
+  log_library::Logger logger(std::move(sinks));
+
+  uint64_t pushed = 0;
+  const auto push = [&](LogLevel level, int i) {
+    while (!logger.push_log(level, "record #{}", i)) {
+      std::this_thread::yield();
+    }
+    ++pushed;
+  };
+
+  // Quiet records stay in memory and the oldest get overwritten.
+  for (int i = 0; i < 500; ++i) {
+    push(LOG_LEVEL_DEBUG, i);
+  }
+  wait_for_consumer(logger, pushed);
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    assert(lines.empty());
+  }
+  assert(flight->overwritten_count() > 0);
+
+  // An error dumps the recent context, itself last.
+  push(LOG_LEVEL_ERROR, 500);
+  wait_for_consumer(logger, pushed);
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    assert(flight->dump_count() == 1);
+    assert(lines.size() > 10);
+    assert(lines.front().starts_with("--- flight recorder dump (trigger"));
+    assert(lines.back() == "--- end of flight recorder dump ---\n");
+    assert(lines[lines.size() - 2].find("ERROR") != std::string::npos);
+    assert(lines[lines.size() - 2].ends_with("record #500\n"));
+    assert(lines[lines.size() - 3].find("record #499") != std::string::npos);
+    size_t bytes = 0;
+    for (size_t i = 1; i + 1 < lines.size(); ++i) {
+      bytes += lines[i].size();
+    }
+    assert(bytes <= config.capacity_bytes);
+    lines.clear();
+  }
+
+  // An explicit request is served even though nothing else is logged.
+  push(LOG_LEVEL_DEBUG, 501);
+  push(LOG_LEVEL_INFO, 502);
+  wait_for_consumer(logger, pushed);
+  flight->request_dump();
+  wait_for_dumps(*flight, 2);
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    assert(lines.size() == 4);
+    assert(lines[0].starts_with("--- flight recorder dump (requested)"));
+    assert(lines[1].find("record #501") != std::string::npos);
+    assert(lines[2].find("record #502") != std::string::npos);
+    lines.clear();
+  }
+
+  // So is the dump signal, and the handler it replaced still runs.
+  push(LOG_LEVEL_DEBUG, 503);
+  wait_for_consumer(logger, pushed);
+  raise(SIGUSR2);
+  wait_for_dumps(*flight, 3);
+  assert(g_previous_handler_calls == 1);
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    assert(lines.size() == 3);
+    assert(lines[1].find("record #503") != std::string::npos);
+  }
+
+  logger.shutdown();
+
+  std::cout << "Flight recorder test passed." << std::endl;
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include <log_library/log_macros.h>
+#include <log_library/logger.h>
+#include <log_library/sink.h>
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_sinks.h"
+
+std::atomic<int> g_evaluations{0};
+std::atomic<std::thread::id> g_lazy_thread{};
+
+int expensive(int value) {
+  g_evaluations.fetch_add(1, std::memory_order_relaxed);
+  return value;
+}
+
+int main() {
+  std::vector<std::string> lines;
+  std::mutex mtx;
+
+  std::vector<std::unique_ptr<log_library::Sink>> sinks;
+  sinks.push_back(std::make_unique<CollectingSink>(lines, mtx));
+  log_library::LoggerConfig config;
+  config.level = LOG_LEVEL_INFO;
+  log_library::init_default_logger(std::move(sinks), config);
+  auto* logger = log_library::default_logger();
+
+  // Disabled statements must not evaluate their arguments.
+  LOG_DEBUG("disabled {}", expensive(1));
+  assert(g_evaluations == 0);
+  LOG_INFO("enabled {}", expensive(2));
+  assert(g_evaluations == 1);
+
+  logger->set_level(LOG_LEVEL_ERROR);
+  LOG_WARN("disabled at runtime {}", expensive(3));
+  assert(g_evaluations == 1);
+  assert(!logger->push_log(LOG_LEVEL_INFO, "filtered {}", 4));
+  assert(logger->dropped_count() == 0 && "Filtered records are not drops");
+  LOG_ERROR("still enabled {}", expensive(5));
+  assert(g_evaluations == 2);
+
+  // Lazy arguments run on the consumer thread, and only when enabled.
+  const auto producer = std::this_thread::get_id();
+  LOG_ERROR("lazy {}", log_library::lazy([] {
+              g_lazy_thread = std::this_thread::get_id();
+              return std::string("value");
+            }));
+  LOG_INFO("lazy disabled {}", log_library::lazy([] {
+             g_evaluations.fetch_add(100);
+             return 0;
+           }));
+
+  log_library::shutdown_default_logger();
+
+  assert(g_evaluations == 2);
+  assert(g_lazy_thread.load() != std::thread::id{});
+  assert(g_lazy_thread.load() != producer);
+
+  assert(lines.size() == 3);
+  assert(lines[0].find("INFO [") != std::string::npos &&
+         lines[0].ends_with("enabled 2\n"));
+  assert(lines[1].ends_with("still enabled 5\n"));
+  assert(lines[2].ends_with("lazy value\n"));
+
+  // Only the retired logger's shell is left: records through a stale
+  // pointer are dropped without touching the freed queues.
+  assert(!logger->push_log(LOG_LEVEL_ERROR, "after shutdown {}", 6));
+  assert(logger->dropped_count() == 1);
+  assert(logger->metrics().queue_capacity == 0);
+
+  std::cout << "Level filter test passed." << std::endl;
+  return 0;
+}
@@ -0,0 +1,332 @@
+#include <log_library/config.h>
+#include <log_library/internal/crc32c.hpp>
+#include <log_library/internal/segment_frame.hpp>
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "frame_reader.h"
+#include "line_scan.h"
+
+namespace fs = std::filesystem;
+
+// Segments as the file sink leaves them: records, then NUL padding up to
+// the preallocated size.
+constexpr size_t SEGMENT_SIZE = 256 * 1024;
+
+const char* const THREADS[] = {"main", "worker-1", "worker-2", "io"};
+
+struct Query {
+  std::optional<LogLevel> level;
+  std::optional<int64_t> since_us;
+  std::optional<int64_t> until_us;
+  std::string thread;
+  std::string grep;
+};
+
+std::string timestamp(int64_t us) {
+  const int64_t seconds = us / 1'000'000;
+  return std::format("2026-01-31T{:02}:{:02}:{:02}.{:06}Z", seconds / 3600,
+                     seconds / 60 % 60, seconds % 60, us % 1'000'000);
+}
+
+bool is_record(std::string_view line) {
+  return line.size() > 27 && line[4] == '-' && line[10] == 'T' &&
+         line[26] == 'Z' && line[27] == ' ';
+}
+
+int64_t parse_us(std::string_view record) {
+  const auto field = [&](size_t at) {
+    return std::stoll(std::string(record.substr(at, 2)));
+  };
+  return (field(11) * 3600 + field(14) * 60 + field(17)) * 1'000'000 +
+         std::stoll(std::string(record.substr(20, 6)));
+}
+
+// Splits a segment into records the plain way: a record starts at every
+// line with a timestamp and runs until the next one. Lines before the
+// first timestamp (the end of a record from the previous segment) are a
+// record of their own.
+std::vector<std::string_view> split_records(std::string_view text) {
+  std::vector<std::string_view> records;
+  size_t start = 0;
+  for (size_t pos = 0; pos < text.size();) {
+    const size_t end = std::min(text.find('\n', pos), text.size() - 1) + 1;
+    if (pos > start && is_record(text.substr(pos))) {
+      records.push_back(text.substr(start, pos - start));
+      start = pos;
+    }
+    pos = end;
+  }
+  if (start < text.size()) {
+    records.push_back(text.substr(start));
+  }
+  return records;
+}
+
+bool reference_match(std::string_view record, const Query& query) {
+  if (!query.grep.empty() && record.find(query.grep) == std::string::npos) {
+    return false;
+  }
+  if (!query.level && !query.since_us && !query.until_us &&
+      query.thread.empty()) {
+    return true;
+  }
+  if (!is_record(record)) {
+    return false;
+  }
+  const int64_t us = parse_us(record);
+  if ((query.since_us && us < *query.since_us) ||
+      (query.until_us && us >= *query.until_us)) {
+    return false;
+  }
+  const auto rest = record.substr(28);
+  const auto level_name = rest.substr(0, rest.find(' '));
+  if (query.level) {
+    bool at_least = false;
+    for (int level = *query.level; level < LOG_LEVEL_NONE; ++level) {
+      at_least |= level_name == to_string(static_cast<LogLevel>(level));
+    }
+    if (!at_least) {
+      return false;
+    }
+  }
+  const auto thread = " [" + query.thread + "]: ";
+  return query.thread.empty() ||
+         rest.substr(level_name.size()).starts_with(thread);
+}
+
+std::string reference(const std::vector<std::string>& segments,
+                      const Query& query) {
+  std::string out;
+  for (const auto& segment : segments) {
+    for (const auto record : split_records(segment)) {
+      if (reference_match(record, query)) {
+        out += record;
+      }
+    }
+  }
+  return out;
+}
+
+std::string read_file(const fs::path& path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+std::string run_query(const std::vector<fs::path>& paths,
+                      const std::vector<std::string>& args) {
+  std::string command = LOG_QUERY_PATH;
+  for (const auto& arg : args) {
+    command += " '" + arg + "'";
+  }
+  for (const auto& path : paths) {
+    command += " " + path.string();
+  }
+  FILE* pipe = popen(command.c_str(), "r");
+  assert(pipe);
+  std::string out;
+  char buffer[65536];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+    out.append(buffer, n);
+  }
+  assert(pclose(pipe) == 0);
+  return out;
+}
+
+std::vector<std::string> query_args(const Query& query) {
+  std::vector<std::string> args;
+  if (query.level) {
+    args.insert(args.end(), {"--level", to_string(*query.level)});
+  }
+  if (query.since_us) {
+    args.insert(args.end(), {"--since", timestamp(*query.since_us)});
+  }
+  if (query.until_us) {
+    args.insert(args.end(), {"--until", timestamp(*query.until_us)});
+  }
+  if (!query.thread.empty()) {
+    args.insert(args.end(), {"--thread", query.thread});
+  }
+  if (!query.grep.empty()) {
+    args.insert(args.end(), {"--grep", query.grep});
+  }
+  return args;
+}
+
+// The SIMD search agrees with std::string_view::find, including matches
+// straddling its 16-byte blocks and at the very end.
+void test_find() {
+  std::mt19937 random(7);
+  for (int round = 0; round < 2000; ++round) {
+    std::string haystack(random() % 100, 'a');
+    for (auto& c : haystack) {
+      c = static_cast<char>('a' + random() % 3);
+    }
+    std::string needle(1 + random() % 6, 'a');
+    for (auto& c : needle) {
+      c = static_cast<char>('a' + random() % 3);
+    }
+    assert(log_query::find(haystack, needle) ==
+           std::string_view(haystack).find(needle));
+  }
+  assert(log_query::find("abc", "") == 0);
+  assert(log_query::find("ab", "abc") == std::string_view::npos);
+}
+
+std::string frame(uint64_t sequence, uint32_t records,
+                  std::string_view payload) {
+  log_library::internal::FrameHeader header{};
+  header.magic = log_library::internal::FRAME_MAGIC;
+  header.size = static_cast<uint32_t>(payload.size());
+  header.sequence = sequence;
+  header.records = records;
+  header.crc = log_library::internal::frame_crc(
+      log_library::internal::crc32c(0, payload.data(), payload.size()),
+      header);
+  std::string out(sizeof(header), '\0');
+  std::memcpy(out.data(), &header, sizeof(header));
+  return out + std::string(payload);
+}
+
+// A framed segment whose first frame is torn is still read as framed:
+// the damage is skipped and the records after it come out as usual.
+void test_torn_first_frame(const fs::path& dir) {
+  std::string payloads[3];
+  for (int f = 0; f < 3; ++f) {
+    for (int r = 0; r < 5; ++r) {
+      payloads[f] += std::format("{} INFO [main]: framed {}\n",
+                                 timestamp(f * 5 + r), f * 5 + r);
+    }
+  }
+  auto segment = frame(0, 5, payloads[0]) + frame(5, 5, payloads[1]) +
+                 frame(10, 5, payloads[2]);
+  segment[0] ^= 0xFF;
+  const size_t second = sizeof(log_library::internal::FrameHeader) +
+                        payloads[0].size();
+
+  const auto found = log_query::FrameReader(segment.data(), segment.size())
+                         .find(0);
+  assert(found && found->offset == second && found->header.sequence == 5);
+
+  const auto path = dir / "torn.log";
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << segment << std::string(SEGMENT_SIZE - segment.size(), '\0');
+  }
+  assert(run_query({path}, {}) == payloads[1] + payloads[2]);
+  assert(run_query({path}, {"--verify"}) ==
+         std::format("{}: frames=2 records=10 damaged_bytes={} "
+                     "damaged_regions=1 missing_records=0\n",
+                     path.string(), second));
+}
+
+int main() {
+  test_find();
+
+  const fs::path dir =
+      fs::temp_directory_path() / std::format("log_query_test_{}", getpid());
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  test_torn_first_frame(dir);
+
+  // Records about 50 ms apart that may run up to 400 ms behind the one
+  // before them (under the default 1 s slack), some of them multi-line.
+  std::mt19937 random(42);
+  std::vector<std::string> segments(5);
+  int64_t now_us = 12LL * 3600 * 1'000'000;
+  int record = 0;
+  for (size_t s = 0; s + 1 < segments.size(); ++s) {
+    auto& text = segments[s];
+    if (s == 1) {
+      // The end of the previous segment's last record.
+      text += "  continued after rotation\n  and more\n";
+    }
+    const size_t target = 64 * 1024 + random() % (96 * 1024);
+    while (text.size() < target) {
+      now_us += 50'000;
+      const int64_t stamp = now_us - (random() % 8 == 0 ? 400'000 : 0);
+      const auto level = static_cast<LogLevel>(random() % LOG_LEVEL_NONE);
+      text += std::format("{} {} [{}]: record {} value={}\n",
+                          timestamp(stamp), to_string(level),
+                          THREADS[random() % 4], record++, random() % 1000);
+      if (random() % 10 == 0) {
+        text += std::format("  detail line for {}\n", record - 1);
+      }
+    }
+    if (s == 0) {
+      text += std::format("{} ERROR [io]: rotation split begins\n",
+                          timestamp(now_us += 50'000));
+    }
+  }
+  // The last segment is freshly preallocated and still empty.
+
+  std::vector<fs::path> paths;
+  for (size_t s = 0; s < segments.size(); ++s) {
+    paths.push_back(dir / std::format("app.log.{}", segments.size() - s));
+    std::ofstream out(paths.back(), std::ios::binary);
+    out << segments[s] << std::string(SEGMENT_SIZE - segments[s].size(), '\0');
+  }
+
+  const int64_t start_us = 12LL * 3600 * 1'000'000;
+  const int64_t span_us = now_us - start_us;
+  std::vector<Query> queries = {
+      {},
+      {.level = LOG_LEVEL_WARN},
+      {.thread = "worker-2"},
+      {.grep = "e"},
+      {.grep = "value=99"},
+      {.grep = "detail line for 1"},
+      {.grep = "continued"},
+      {.grep = "no such text anywhere"},
+      {.since_us = start_us + span_us / 3},
+      {.until_us = start_us + span_us / 2},
+      {.since_us = start_us + span_us / 4, .until_us = start_us + span_us / 2},
+      {.level = LOG_LEVEL_ERROR, .thread = "io", .grep = "record"},
+      {.level = LOG_LEVEL_INFO,
+       .since_us = start_us + span_us / 5,
+       .until_us = now_us,
+       .thread = "main",
+       .grep = "value=1"},
+  };
+  for (const auto& query : queries) {
+    const auto expected = reference(segments, query);
+    auto args = query_args(query);
+    args.insert(args.end(), {"--jobs", "1"});
+    assert(run_query(paths, args) == expected);
+    // Segments scanned in parallel still come out in order.
+    args.back() = "8";
+    assert(run_query(paths, args) == expected);
+  }
+  assert(run_query(paths, {}).find('\0') == std::string::npos);
+
+  std::vector<std::string> count_args = {"--count", "--level", "ERROR"};
+  size_t errors = 0;
+  for (const auto& segment : segments) {
+    for (const auto record : split_records(segment)) {
+      errors += reference_match(record, {.level = LOG_LEVEL_ERROR});
+    }
+  }
+  assert(run_query(paths, count_args) == std::format("{}\n", errors));
+
+  fs::remove_all(dir);
+  std::cout << "Log query test passed: " << record << " records, "
+            << queries.size() << " queries." << std::endl;
+  return 0;
+}
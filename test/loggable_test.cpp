@@ -0,0 +1,108 @@
+#include <log_library/logger.h>
+#include <log_library/sink.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_sinks.h"
+
+// Not trivially copyable and far larger than a record's argument space.
+// Its 16-byte snapshot leaves room for one more small argument.
+struct Order {
+  std::string symbol;
+  std::vector<double> fills;
+};
+
+std::atomic<int> g_encodes{0};
+std::atomic<std::thread::id> g_format_thread{};
+
+template <>
+struct log_library::loggable<Order> {
+  struct snapshot_type {
+    char symbol[8];
+    uint32_t fill_count;
+    float total;
+  };
+
+  static snapshot_type encode(const Order& order) {
+    g_encodes.fetch_add(1, std::memory_order_relaxed);
+    snapshot_type snapshot{};
+    std::memcpy(snapshot.symbol, order.symbol.data(),
+                std::min(order.symbol.size(), sizeof(snapshot.symbol)));
+    snapshot.fill_count = static_cast<uint32_t>(order.fills.size());
+    snapshot.total = static_cast<float>(
+        std::accumulate(order.fills.begin(), order.fills.end(), 0.0));
+    return snapshot;
+  }
+
+  static Order decode(const snapshot_type& snapshot) {
+    Order order;
+    order.symbol.assign(snapshot.symbol,
+                        strnlen(snapshot.symbol, sizeof(snapshot.symbol)));
+    order.fills.assign(snapshot.fill_count,
+                       snapshot.fill_count ? snapshot.total / snapshot.fill_count
+                                           : 0.0);
+    return order;
+  }
+};
+
+template <>
+struct std::formatter<Order> : std::formatter<std::string> {
+  auto format(const Order& order, std::format_context& ctx) const {
+    g_format_thread = std::this_thread::get_id();
+    const double total =
+        std::accumulate(order.fills.begin(), order.fills.end(), 0.0);
+    return std::formatter<std::string>::format(
+        std::format("{}x{} total={}", order.symbol, order.fills.size(), total),
+        ctx);
+  }
+};
+
+static_assert(log_library::Loggable<Order>);
+static_assert(!log_library::Loggable<int>);
+
+int main() {
+  std::vector<std::string> lines;
+  std::mutex mtx;
+
+  std::vector<std::unique_ptr<log_library::Sink>> sinks;
+  sinks.push_back(std::make_unique<CollectingSink>(lines, mtx));
+  log_library::Logger logger(std::move(sinks));
+
+  {
+    Order order{"ACME", {10.0, 20.0, 30.0}};
+    assert(logger.push_log(LOG_LEVEL_INFO, "order {} id={}", order, 42));
+    // The record must not depend on the original after the call returns.
+    order.symbol = "GONE";
+    order.fills.clear();
+  }
+
+  {
+    auto batch = logger.begin_batch();
+    const Order order{"BATCHED", {1.5}};
+    logger.push_log(LOG_LEVEL_WARN, "batched {}", order);
+  }
+
+  logger.shutdown();
+
+  assert(g_encodes == 2);
+  assert(g_format_thread.load() != std::thread::id{});
+  assert(g_format_thread.load() != std::this_thread::get_id());
+
+  assert(lines.size() == 2);
+  assert(lines[0].ends_with("order ACMEx3 total=60 id=42\n"));
+  assert(lines[1].ends_with("batched BATCHEDx1 total=1.5\n"));
+
+  std::cout << "Loggable test passed." << std::endl;
+  return 0;
+}
@@ -0,0 +1,102 @@
+#include <log_library/logger.h>
+#include <log_library/sink.h>
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_sinks.h"
+
+// Reports a sink error count, to check it reaches the snapshot.
+class RecordingSink : public CollectingSink {
+ public:
+  using CollectingSink::CollectingSink;
+
+  void collect_metrics(log_library::SinkMetrics& metrics) const override {
+    metrics.errors = 7;
+  }
+};
+
+constexpr int MESSAGES = 500;
+
+int main() {
+  std::vector<std::string> lines;
+  std::mutex mtx;
+
+  std::vector<std::unique_ptr<log_library::Sink>> sinks;
+  sinks.push_back(std::make_unique<RecordingSink>(lines, mtx));
+
+  log_library::LoggerConfig config;
+  config.metrics_report_interval = std::chrono::milliseconds(20);
+  log_library::Logger logger(std::move(sinks), config);
+
+  int accepted = 0;
+  for (int i = 0; i < MESSAGES; ++i) {
+    while (!logger.push_log(LOG_LEVEL_INFO, "Metrics test message #{}", i)) {
+      std::this_thread::yield();
+    }
+    ++accepted;
+  }
+
+  // Wait for the consumer to drain and emit at least one report.
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  const auto reported = [&] {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto& line : lines) {
+      if (line.find("logger metrics:") != std::string::npos) {
+        return true;
+      }
+    }
+    return false;
+  };
+  while (logger.metrics().records_processed <
+             static_cast<uint64_t>(accepted) ||
+         !reported()) {
+    assert(std::chrono::steady_clock::now() < deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  const auto metrics = logger.metrics();
+  assert(metrics.records_processed == static_cast<uint64_t>(accepted));
+  assert(metrics.queue_capacity > 0);
+  assert(metrics.queue_high_water >= 1);
+  assert(metrics.queue_high_water <= metrics.queue_capacity);
+  assert(metrics.queue_latency_ns.count == metrics.records_processed);
+  assert(metrics.format_ns.count > 0);
+  assert(metrics.format_ns.count <= metrics.records_processed);
+
+  assert(metrics.sinks.size() == 1);
+  const auto& sink = metrics.sinks.front();
+  assert(sink.records >= metrics.records_processed);
+  assert(sink.bytes > 0);
+  assert(sink.write_ns.count > 0);
+  assert(sink.errors == 7 && "collect_metrics was not consulted");
+
+  logger.shutdown();
+
+  const std::regex record_regex(
+      R"(^\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}\.\d{6}Z INFO \[[^\]]*\]: )");
+  int reports = 0;
+  int records = 0;
+  for (const auto& line : lines) {
+    assert(std::regex_search(line, record_regex) && "Malformed line prefix");
+    if (line.find("[log_consumer]: logger metrics:") != std::string::npos) {
+      ++reports;
+    } else {
+      ++records;
+    }
+  }
+  assert(records == accepted);
+  assert(reports >= 1 && "No periodic metrics report was emitted");
+
+  std::cout << "Metrics test passed: " << records << " records, " << reports
+            << " reports." << std::endl;
+  return 0;
+}
@@ -0,0 +1,312 @@
+#include <log_library/logger.h>
+#include <log_library/sink.h>
+#include <log_library/sinks/network_sink.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_sinks.h"
+
+// Logs `count` records through a logger whose only sink is `sink`, then
+// destroys it so the sink flushes and closes its socket.
+void log_through(std::unique_ptr<log_library::Sink> sink, int count) {
+  std::vector<std::unique_ptr<log_library::Sink>> sinks;
+  sinks.push_back(std::move(sink));
+  log_library::Logger logger(std::move(sinks));
+  for (int i = 0; i < count; ++i) {
+    while (!logger.push_log(i % 2 ? LOG_LEVEL_WARN : LOG_LEVEL_INFO,
+                            "network record #{}", i)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+// Receives datagrams until `count` arrived or the socket stays quiet.
+std::vector<std::string> receive_datagrams(int fd, int count) {
+  std::vector<std::string> received;
+  std::vector<char> buffer(65536);
+  while (static_cast<int>(received.size()) < count) {
+    pollfd descriptor{fd, POLLIN, 0};
+    if (poll(&descriptor, 1, 5000) <= 0) {
+      break;
+    }
+    const auto n = recv(fd, buffer.data(), buffer.size(), 0);
+    assert(n > 0);
+    received.emplace_back(buffer.data(), n);
+  }
+  return received;
+}
+
+void check_syslog(const std::string& message, int i) {
+  // <PRI>1 TIMESTAMP HOSTNAME APP-NAME PROCID - - MSG
+  const auto expected_pri = i % 2 ? "<12>1 " : "<14>1 ";
+  assert(message.starts_with(expected_pri));
+  assert(message[6 + 26] == 'Z');
+  assert(message.find(" net_test " + std::to_string(getpid()) + " - - ") !=
+         std::string::npos);
+  assert(message.ends_with(std::format("]: network record #{}", i)));
+}
+
+void test_unix_syslog() {
+  const auto path = std::format("/tmp/lockfree_log_net_{}.sock", getpid());
+  unlink(path.c_str());
+  const int server = socket(AF_UNIX, SOCK_DGRAM, 0);
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strcpy(address.sun_path, path.c_str());
+  assert(bind(server, reinterpret_cast<sockaddr*>(&address),
+              sizeof(address)) == 0);
+
+  // Enough records to fill the receive queue, so the sink has to back off
+  // and retry.
+  constexpr int MESSAGES = 5000;
+  std::vector<std::string> received;
+  std::thread reader([&] { received = receive_datagrams(server, MESSAGES); });
+
+  log_library::NetworkSinkConfig config;
+  config.address = path;
+  config.app_name = "net_test";
+  log_through(log_library::create_network_sink(config), MESSAGES);
+  reader.join();
+
+  assert(received.size() == MESSAGES);
+  for (int i = 0; i < MESSAGES; ++i) {
+    check_syslog(received[i], i);
+  }
+
+  // journald native protocol on the same kind of socket.
+  config.format = log_library::NetworkFormat::Journald;
+  log_through(log_library::create_network_sink(config), 2);
+  received = receive_datagrams(server, 2);
+  assert(received.size() == 2);
+  const auto& journal = received[1];
+  assert(journal.starts_with("PRIORITY=4\nSYSLOG_IDENTIFIER=net_test\n"));
+  const auto field = journal.find("MESSAGE\n");
+  assert(field != std::string::npos);
+  uint64_t size = 0;
+  std::memcpy(&size, journal.data() + field + 8, sizeof(size));
+  const auto text = journal.substr(field + 16, size);
+  assert(text.starts_with("WARN [") && text.ends_with("network record #1"));
+  assert(journal.size() == field + 16 + size + 1 && journal.back() == '\n');
+
+  close(server);
+  unlink(path.c_str());
+}
+
+int bind_loopback(int type, uint16_t& port) {
+  const int fd = socket(AF_INET, type, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  assert(bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) ==
+         0);
+  socklen_t length = sizeof(address);
+  getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+  port = ntohs(address.sin_port);
+  return fd;
+}
+
+void test_udp() {
+  uint16_t port = 0;
+  const int server = bind_loopback(SOCK_DGRAM, port);
+
+  constexpr int MESSAGES = 100;
+  log_library::NetworkSinkConfig config;
+  config.transport = log_library::NetworkTransport::Udp;
+  config.address = "127.0.0.1";
+  config.port = port;
+  config.app_name = "net_test";
+  log_through(log_library::create_network_sink(config), MESSAGES);
+
+  const auto received = receive_datagrams(server, MESSAGES);
+  assert(received.size() == MESSAGES);
+  for (int i = 0; i < MESSAGES; ++i) {
+    check_syslog(received[i], i);
+  }
+  close(server);
+}
+
+void test_tcp() {
+  uint16_t port = 0;
+  const int server = bind_loopback(SOCK_STREAM, port);
+  assert(listen(server, 1) == 0);
+
+  // Reads the whole stream; the sink closes it when the logger goes away.
+  std::string stream;
+  std::thread reader([&] {
+    const int client = accept(server, nullptr, nullptr);
+    assert(client >= 0);
+    char buffer[65536];
+    ssize_t n;
+    while ((n = read(client, buffer, sizeof(buffer))) > 0) {
+      stream.append(buffer, n);
+    }
+    close(client);
+  });
+
+  constexpr int MESSAGES = 20000;
+  log_library::NetworkSinkConfig config;
+  config.transport = log_library::NetworkTransport::Tcp;
+  config.address = "127.0.0.1";
+  config.port = port;
+  config.app_name = "net_test";
+  log_through(log_library::create_network_sink(config), MESSAGES);
+  reader.join();
+  close(server);
+
+  // Octet-counted frames: "MSG-LEN SP SYSLOG-MSG".
+  size_t offset = 0;
+  int frames = 0;
+  while (offset < stream.size()) {
+    const auto space = stream.find(' ', offset);
+    assert(space != std::string::npos);
+    const auto length = std::stoul(stream.substr(offset, space - offset));
+    check_syslog(stream.substr(space + 1, length), frames++);
+    offset = space + 1 + length;
+  }
+  assert(offset == stream.size());
+  assert(frames == MESSAGES);
+}
+
+void test_fallback() {
+  // Nothing listens on this port once the socket is closed.
+  uint16_t port = 0;
+  close(bind_loopback(SOCK_STREAM, port));
+
+  std::vector<std::string> lines;
+  std::mutex mtx;
+  constexpr int MESSAGES = 300;
+  log_library::NetworkSinkConfig config;
+  config.transport = log_library::NetworkTransport::Tcp;
+  config.address = "127.0.0.1";
+  config.port = port;
+  log_through(log_library::create_network_sink(
+                  config, std::make_unique<CollectingSink>(lines, mtx)),
+              MESSAGES);
+
+  assert(lines.size() == MESSAGES);
+  for (int i = 0; i < MESSAGES; ++i) {
+    assert(lines[i].ends_with(std::format("network record #{}\n", i)));
+  }
+}
+
+// A collector that accepts the connection but does not read: flush()
+// returns at once, and every record ends up either on the wire or in the
+// fallback, never in both.
+void test_stalled_tcp(int messages, size_t record_size,
+                      size_t retry_buffer_bytes) {
+  uint16_t port = 0;
+  const int server = bind_loopback(SOCK_STREAM, port);
+  // A small receive window, so the socket stalls long before the records
+  // run out however large the system's buffers are.
+  const int window = 16 * 1024;
+  setsockopt(server, SOL_SOCKET, SO_RCVBUF, &window, sizeof(window));
+  assert(listen(server, 1) == 0);
+
+  std::vector<std::string> lines;
+  std::mutex mtx;
+  log_library::NetworkSinkConfig config;
+  config.transport = log_library::NetworkTransport::Tcp;
+  config.address = "127.0.0.1";
+  config.port = port;
+  config.flush_timeout = std::chrono::milliseconds(200);
+  config.retry_buffer_bytes = retry_buffer_bytes;
+  auto sink = log_library::create_network_sink(
+      config, std::make_unique<CollectingSink>(lines, mtx));
+
+  const std::string padding(record_size, 'x');
+  for (int i = 0; i < messages; ++i) {
+    sink->write(std::format("stalled #{} {}\n", i, padding), LOG_LEVEL_INFO);
+  }
+  const auto start = std::chrono::steady_clock::now();
+  sink->flush();
+  assert(std::chrono::steady_clock::now() - start <
+         std::chrono::milliseconds(100));
+  // Records larger than the retry buffer are only kept when the socket
+  // stalled in the middle of one, not at a record boundary.
+  if (record_size < retry_buffer_bytes) {
+    assert(sink->deadline() != std::chrono::steady_clock::time_point::max());
+  }
+  sink.reset();
+
+  std::string stream;
+  const int client = accept(server, nullptr, nullptr);
+  assert(client >= 0);
+  char buffer[65536];
+  ssize_t n;
+  while ((n = read(client, buffer, sizeof(buffer))) > 0) {
+    stream.append(buffer, n);
+  }
+  close(client);
+  close(server);
+
+  std::vector<int> seen(messages, 0);
+  const auto record_index = [](const std::string& text) {
+    const auto at = text.find("stalled #");
+    assert(at != std::string::npos);
+    return std::stoi(text.substr(at + 9));
+  };
+  size_t offset = 0;
+  while (offset < stream.size()) {
+    const auto space = stream.find(' ', offset);
+    const auto length = std::stoul(stream.substr(offset, space - offset));
+    if (space + 1 + length > stream.size()) {
+      break;  // The frame the socket only took part of.
+    }
+    ++seen[record_index(stream.substr(space + 1, length))];
+    offset = space + 1 + length;
+  }
+  for (const auto& line : lines) {
+    ++seen[record_index(line)];
+  }
+  int missing = 0;
+  for (int count : seen) {
+    assert(count <= 1);
+    missing += count == 0;
+  }
+  assert(missing == (offset < stream.size() ? 1 : 0));
+}
+
+void test_unresolvable() {
+  log_library::NetworkSinkConfig config;
+  config.transport = log_library::NetworkTransport::Udp;
+  config.address = "no-such-host.invalid";
+  bool threw = false;
+  try {
+    log_library::create_network_sink(config);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+int main() {
+  test_unix_syslog();
+  test_udp();
+  test_tcp();
+  test_fallback();
+  test_stalled_tcp(4000, 1000, 1024 * 1024);
+  // Records larger than the whole retry buffer: the one the socket stalls
+  // in the middle of still finishes before anything else is sent.
+  test_stalled_tcp(64, 256 * 1024, 64 * 1024);
+  test_unresolvable();
+
+  std::cout << "Network sink test passed." << std::endl;
+  return 0;
+}
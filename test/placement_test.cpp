@@ -0,0 +1,97 @@
+#include <log_library/logger.h>
+#include <log_library/sink.h>
+
+#include <sched.h>
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// Records the scheduling state of whichever thread writes to it.
+class PlacementSink : public log_library::Sink {
+ public:
+  void write(std::string_view message, LogLevel level) override {
+    cpu_set_t cpus;
+    sched_getaffinity(0, sizeof(cpus), &cpus);
+    cpu_count = CPU_COUNT(&cpus);
+    first_cpu = -1;
+    for (int cpu = 0; cpu < CPU_SETSIZE && first_cpu < 0; ++cpu) {
+      if (CPU_ISSET(cpu, &cpus)) {
+        first_cpu = cpu;
+      }
+    }
+    policy = sched_getscheduler(0);
+    writes.fetch_add(1);
+  }
+
+  void flush() override {}
+
+  std::atomic<int> writes{0};
+  int cpu_count = 0;
+  int first_cpu = -1;
+  int policy = -1;
+};
+
+std::vector<std::unique_ptr<log_library::Sink>> one_sink(
+    std::unique_ptr<log_library::Sink> sink) {
+  std::vector<std::unique_ptr<log_library::Sink>> sinks;
+  sinks.push_back(std::move(sink));
+  return sinks;
+}
+
+int main() {
+  cpu_set_t allowed;
+  sched_getaffinity(0, sizeof(allowed), &allowed);
+  int cpu = 0;
+  while (!CPU_ISSET(cpu, &allowed)) {
+    ++cpu;
+  }
+
+  auto sink = std::make_unique<PlacementSink>();
+  auto* placement = sink.get();
+
+  log_library::LoggerConfig config;
+  config.consumer_cpus = {cpu};
+  config.consumer_idle_priority = true;
+  config.queue_numa_node = 0;
+  {
+    log_library::Logger logger(one_sink(std::move(sink)), config);
+    assert(logger.push_log(LOG_LEVEL_INFO, "placed"));
+    while (placement->writes.load() == 0) {
+      std::this_thread::yield();
+    }
+    assert(placement->cpu_count == 1);
+    assert(placement->first_cpu == cpu);
+    assert(placement->policy == SCHED_IDLE);
+  }
+
+  // Settings that cannot be applied fail the constructor.
+  bool threw = false;
+  config = {};
+  config.consumer_cpus = {CPU_SETSIZE};
+  try {
+    log_library::Logger logger(one_sink(std::make_unique<PlacementSink>()),
+                               config);
+  } catch (const std::system_error&) {
+    threw = true;
+  }
+  assert(threw && "An invalid CPU was accepted");
+
+  threw = false;
+  config = {};
+  config.queue_numa_node = 1000;
+  try {
+    log_library::Logger logger(one_sink(std::make_unique<PlacementSink>()),
+                               config);
+  } catch (const std::system_error&) {
+    threw = true;
+  }
+  assert(threw && "A nonexistent NUMA node was accepted");
+
+  std::cout << "Placement test passed." << std::endl;
+  return 0;
+}
@@ -0,0 +1,129 @@
+#include <log_library/log_macros.h>
+#include <log_library/logger.h>
+#include <log_library/sink.h>
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_sinks.h"
+
+size_t count(const std::vector<std::string>& lines, std::string_view text) {
+  size_t n = 0;
+  for (const auto& line : lines) {
+    n += line.find(text) != std::string::npos;
+  }
+  return n;
+}
+
+std::atomic<int> g_evaluations{0};
+
+int expensive(int value) {
+  g_evaluations.fetch_add(1, std::memory_order_relaxed);
+  return value;
+}
+
+int main() {
+  std::vector<std::string> lines;
+  std::mutex mtx;
+
+  {
+    std::vector<std::unique_ptr<log_library::Sink>> sinks;
+    sinks.push_back(std::make_unique<CollectingSink>(lines, mtx));
+    log_library::init_default_logger(std::move(sinks));
+
+    // Per-site counters: exactly one in ten, and skipped executions do not
+    // evaluate their arguments.
+    for (int i = 0; i < 1000; ++i) {
+      LOG_EVERY_N(LOG_LEVEL_DEBUG, 10, "every tenth {}", expensive(i));
+      if (i % 50 == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+    assert(g_evaluations == 100);
+
+    // n <= 1 keeps every execution rather than dividing by zero.
+    const int every = 0;
+    for (int i = 0; i < 5; ++i) {
+      LOG_EVERY_N(LOG_LEVEL_DEBUG, every, "every time {}", i);
+    }
+
+    // `n` is evaluated once per execution.
+    int n_evaluations = 0;
+    for (int i = 0; i < 9; ++i) {
+      LOG_EVERY_N(LOG_LEVEL_DEBUG, (++n_evaluations, 3), "every third {}", i);
+    }
+    assert(n_evaluations == 9);
+
+    for (int i = 0; i < 40000; ++i) {
+      LOG_SAMPLED(LOG_LEVEL_DEBUG, 4, "random quarter {}", i);
+      if (i % 500 == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+    LOG_INFO("unsampled");
+    log_library::shutdown_default_logger();
+  }
+
+  assert(count(lines, "[1/10] every tenth ") == 100);
+  assert(count(lines, "every tenth ") == 100);
+  assert(count(lines, "]: every time ") == 5);
+  assert(count(lines, "[1/3] every third ") == 3);
+  const auto quarter = count(lines, "[1/4] random quarter ");
+  assert(quarter == count(lines, "random quarter "));
+  assert(quarter > 9000 && quarter < 11000);
+  assert(count(lines, "]: unsampled") == 1);
+
+  // Adaptive sampling: with the consumer stuck, DEBUG records past half the
+  // queue are thinned out and tagged; WARN records never are.
+  lines.clear();
+  {
+    log_library::LoggerConfig config;
+    config.adaptive_sampling_threshold = 0.5;
+    config.adaptive_sampling_rate = 8;
+    std::vector<std::unique_ptr<log_library::Sink>> sinks;
+    sinks.push_back(std::make_unique<CollectingSink>(lines, mtx));
+    log_library::Logger logger(std::move(sinks), config);
+
+    CollectingSink::hold = true;
+    for (int i = 0; i < 2000; ++i) {
+      logger.push_log(LOG_LEVEL_DEBUG, "debug {}", i);
+    }
+    // A rate that is already high saturates instead of wrapping around.
+    for (int i = 0; i < 200; ++i) {
+      logger.push_sampled(LOG_LEVEL_DEBUG, 1u << 30, "huge {}", i);
+    }
+    for (int i = 0; i < 100; ++i) {
+      logger.push_log(LOG_LEVEL_WARN, "warn {}", i);
+    }
+    CollectingSink::hold = false;
+  }
+
+  const auto tagged = count(lines, "[1/8] debug ");
+  assert(tagged > 0);
+  assert(count(lines, "debug ") - tagged >= 400);
+  assert(count(lines, "[1/8] warn ") == 0);
+  assert(count(lines, "[1/4294967295] huge ") > 0);
+  assert(count(lines, "[1/4294967295] huge ") == count(lines, "huge "));
+  assert(count(lines, "warn ") == 100);
+
+  log_library::LoggerConfig invalid;
+  invalid.adaptive_sampling_threshold = 1.5;
+  bool threw = false;
+  try {
+    log_library::Logger logger({}, invalid);
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  assert(threw);
+
+  std::cout << "Sampling test passed: " << quarter << " of 40000 kept at 1/4, "
+            << tagged << " adaptively sampled." << std::endl;
+  return 0;
+}
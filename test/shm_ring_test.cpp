@@ -0,0 +1,203 @@
+#include <log_library/internal/shm_ring.hpp>
+#include <log_library/logger.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using log_library::internal::ShmRing;
+
+class NullSink : public log_library::Sink {
+ public:
+  void write(std::string_view, LogLevel) override {}
+  void flush() override {}
+};
+
+constexpr int CHILD_RECORDS = 20;
+constexpr auto NO_STALL = std::chrono::milliseconds(100);
+
+// A raw view of the ring's head counter and slot turns, laid out as in
+// shm_ring.cpp, to leave a slot the way a producer that died between
+// claiming and publishing it does.
+class RawRing {
+ public:
+  static constexpr uint64_t TURN_WRITING = 1ULL << 63;
+  static constexpr uint64_t TURN_ABANDONED = 1ULL << 62;
+
+  RawRing(const std::string& name, size_t slot_count)
+      : size_(4096 + slot_count * ShmRing::SLOT_SIZE), mask_(slot_count - 1) {
+    const int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    assert(fd >= 0);
+    mapping_ = static_cast<char*>(
+        mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+    close(fd);
+    assert(mapping_ != MAP_FAILED);
+  }
+
+  ~RawRing() { munmap(mapping_, size_); }
+
+  std::atomic_ref<uint64_t> head() const {
+    return std::atomic_ref<uint64_t>(
+        *reinterpret_cast<uint64_t*>(mapping_ + 64));
+  }
+
+  std::atomic_ref<uint64_t> turn(uint64_t position) const {
+    return std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(
+        mapping_ + 4096 + (position & mask_) * ShmRing::SLOT_SIZE));
+  }
+
+ private:
+  char* mapping_;
+  size_t size_;
+  size_t mask_;
+};
+
+// A producer stuck between claiming a slot and publishing it is given up
+// on after the stall timeout; its slot is skipped on the next lap while it
+// still holds it, and reused once it lets go.
+void test_stalled_producer(ShmRing& ring, const std::string& name) {
+  constexpr auto STALL = std::chrono::milliseconds(50);
+  const size_t capacity = ring.slot_count();
+  RawRing raw(name, capacity);
+  ShmRing::Record record;
+
+  const uint64_t stuck = raw.head().fetch_add(1);
+  raw.turn(stuck).store(stuck | RawRing::TURN_WRITING);
+  assert(ring.try_write(LOG_LEVEL_INFO, 1, "main", "behind the stall"));
+
+  assert(!ring.try_read(record, STALL));
+  std::this_thread::sleep_for(STALL * 2);
+  assert(ring.try_read(record, STALL));
+  assert(record.text == "behind the stall");
+  assert(ring.abandoned() == 1);
+  assert(raw.turn(stuck).load() ==
+         (stuck | RawRing::TURN_WRITING | RawRing::TURN_ABANDONED));
+
+  // Next lap: the record that lands on the held slot is dropped, and the
+  // reader steps over the slot.
+  const uint64_t dropped = ring.dropped();
+  int written = 0;
+  for (size_t i = 0; i < capacity; ++i) {
+    written += ring.try_write(LOG_LEVEL_INFO, 1, "main",
+                              std::format("lap #{}", i));
+  }
+  assert(written == static_cast<int>(capacity) - 1);
+  assert(ring.dropped() == dropped + 1);
+  for (size_t i = 0; i < capacity; ++i) {
+    if (i == capacity - 2) {
+      continue;  // Would have gone into the held slot.
+    }
+    assert(ring.try_read(record, STALL));
+    assert(record.text == std::format("lap #{}", i));
+  }
+  assert(!ring.try_read(record, STALL));
+
+  // The producer finishes and releases the slot as its publish does once
+  // the slot was given up on; from then on the slot is used again.
+  raw.turn(stuck).store(stuck + capacity);
+  for (size_t i = 0; i < capacity; ++i) {
+    assert(ring.try_write(LOG_LEVEL_INFO, 1, "main",
+                          std::format("reused #{}", i)));
+  }
+  assert(ring.dropped() == dropped + 1);
+  for (size_t i = 0; i < capacity; ++i) {
+    assert(ring.try_read(record, STALL));
+    assert(record.text == std::format("reused #{}", i));
+  }
+  assert(!ring.try_read(record, STALL));
+  assert(ring.abandoned() == 1);
+}
+
+int main() {
+  const std::string name = std::format("/log_library_test_{}", getpid());
+  ShmRing::unlink(name);
+
+  auto ring = ShmRing::open(name, 64);
+  assert(ring->slot_count() == 64);
+
+  const std::string long_text(1000, 'x');
+
+  const pid_t child = fork();
+  if (child == 0) {
+    log_library::LoggerConfig config;
+    config.shared_ring = name;
+    log_library::Logger logger({}, config);
+    log_library::set_thread_name("child");
+    for (int i = 0; i < CHILD_RECORDS; ++i) {
+      logger.push_log(LOG_LEVEL_INFO, "child record #{}", i);
+    }
+    // Arguments are formatted before push_log returns in this mode.
+    logger.push_log(LOG_LEVEL_ERROR, "long {}", std::string_view(long_text));
+    // Exit without shutting down: the records already live in the ring.
+    _exit(0);
+  }
+
+  int status = 0;
+  waitpid(child, &status, 0);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  ShmRing::Record record;
+  for (int i = 0; i < CHILD_RECORDS; ++i) {
+    assert(ring->try_read(record, NO_STALL));
+    assert(record.pid == static_cast<uint32_t>(child));
+    assert(record.thread_name == "child");
+    assert(record.level == LOG_LEVEL_INFO);
+    assert(record.text == std::format("child record #{}", i));
+    assert(record.timestamp_ns > 0);
+  }
+
+  assert(ring->try_read(record, NO_STALL));
+  assert(record.level == LOG_LEVEL_ERROR);
+  assert(record.text == "long " + long_text);
+  assert(!ring->try_read(record, NO_STALL));
+
+  // A full ring drops instead of blocking; wrapping keeps records intact.
+  int written = 0;
+  for (int i = 0; i < 100; ++i) {
+    written += ring->try_write(LOG_LEVEL_WARN, i, "main",
+                               std::format("wrap #{}", i));
+  }
+  assert(written == 64);
+  assert(ring->dropped() == 36);
+  for (int i = 0; i < written; ++i) {
+    assert(ring->try_read(record, NO_STALL));
+    assert(record.text == std::format("wrap #{}", i));
+  }
+  assert(!ring->try_read(record, NO_STALL));
+  assert(ring->abandoned() == 0);
+
+  test_stalled_producer(*ring, name);
+
+  // Rejected before the sinks are taken over, so nothing leaks.
+  bool rejected = false;
+  try {
+    log_library::LoggerConfig config;
+    config.shared_ring = name;
+    std::vector<std::unique_ptr<log_library::Sink>> sinks;
+    sinks.push_back(std::make_unique<NullSink>());
+    log_library::Logger logger(std::move(sinks), config);
+  } catch (const std::invalid_argument&) {
+    rejected = true;
+  }
+  assert(rejected);
+
+  ring.reset();
+  ShmRing::unlink(name);
+
+  std::cout << "Shared-memory ring test passed." << std::endl;
+  return 0;
+}
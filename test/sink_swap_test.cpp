@@ -0,0 +1,102 @@
+#include <log_library/logger.h>
+#include <log_library/sink.h>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class CountingSink : public log_library::Sink {
+ public:
+  CountingSink(std::atomic<int>& writes, std::atomic<bool>& flushed,
+               std::atomic<bool>& destroyed)
+      : writes_(writes), flushed_(flushed), destroyed_(destroyed) {}
+
+  ~CountingSink() override { destroyed_ = true; }
+
+  void write(std::string_view message, LogLevel level) override {
+    assert(!destroyed_ && "Write to a destroyed sink!");
+    writes_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void flush() override { flushed_ = true; }
+
+ private:
+  std::atomic<int>& writes_;
+  std::atomic<bool>& flushed_;
+  std::atomic<bool>& destroyed_;
+};
+
+struct SinkProbe {
+  std::atomic<int> writes{0};
+  std::atomic<bool> flushed{false};
+  std::atomic<bool> destroyed{false};
+
+  std::unique_ptr<log_library::Sink> make() {
+    return std::make_unique<CountingSink>(writes, flushed, destroyed);
+  }
+};
+
+int main() {
+  SinkProbe first;
+  SinkProbe second;
+  SinkProbe third;
+
+  std::vector<std::unique_ptr<log_library::Sink>> sinks;
+  sinks.push_back(first.make());
+  log_library::Logger logger(std::move(sinks));
+
+  std::atomic<bool> keep_running = true;
+  std::thread producer([&] {
+    int i = 0;
+    while (keep_running) {
+      logger.push_log(LOG_LEVEL_INFO, "Swap test message #{}", ++i);
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  });
+
+  std::cout << "Starting sink hot-swap test..." << std::endl;
+
+  auto ids = logger.sink_ids();
+  assert(ids.size() == 1);
+  const auto first_id = ids.front();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  const auto second_id = logger.add_sink(second.make());
+  assert(logger.sink_ids().size() == 2);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(logger.remove_sink(first_id));
+  assert(first.flushed && first.destroyed &&
+         "Removed sink was not flushed and destroyed after the swap.");
+  assert(!logger.remove_sink(first_id));
+
+  const int first_writes = first.writes;
+  assert(first_writes > 0);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(logger.replace_sink(second_id, third.make()));
+  assert(second.flushed && second.destroyed);
+  assert(logger.sink_ids() == std::vector<log_library::SinkId>{second_id});
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  keep_running = false;
+  producer.join();
+  logger.shutdown();
+
+  assert(first.writes == first_writes &&
+         "Removed sink kept receiving records.");
+  assert(second.writes > 0);
+  assert(third.writes > 0);
+  assert(third.flushed && !third.destroyed);
+
+  std::cout << "Writes per sink: " << first.writes << ", " << second.writes
+            << ", " << third.writes << std::endl;
+  std::cout << "Sink hot-swap test finished successfully." << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <log_library/sink.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Keeps every record that reaches it in `lines`, guarded by `mtx`. While
+// `hold` is set, writes wait, which keeps the consumer stuck and lets tests
+// fill the queue.
+class CollectingSink : public log_library::Sink {
+ public:
+  CollectingSink(std::vector<std::string>& lines, std::mutex& mtx)
+      : lines_(lines), mtx_(mtx) {}
+
+  void write(std::string_view message, LogLevel level) override {
+    while (hold.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    lines_.emplace_back(message);
+  }
+
+  void flush() override {}
+
+  static inline std::atomic<bool> hold{false};
+
+ private:
+  std::vector<std::string>& lines_;
+  std::mutex& mtx_;
+};
@@ -0,0 +1,154 @@
+#include <log_library/internal/shm_ring.hpp>
+#include <log_library/internal/timestamp_format.hpp>
+#include <log_library/sinks/file_sink.h>
+
+#include <signal.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Drains a shared-memory ring filled by any number of processes whose
+// loggers were configured with LoggerConfig::shared_ring, and owns the file
+// sink they would otherwise each run themselves.
+//
+// Usage: log_collector --ring NAME [--dir DIR] [--file BASENAME]
+//                      [--slots N] [--stall-ms N] [--unlink]
+
+namespace {
+
+std::atomic<bool> g_stop{false};
+
+void on_stop(int) { g_stop.store(true); }
+
+struct Options {
+  std::string ring;
+  log_library::FileSinkConfig file;
+  size_t slots = 16384;
+  std::chrono::milliseconds stall_timeout{1000};
+  bool unlink_on_exit = false;
+};
+
+bool parse(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view flag = argv[i];
+    if (flag == "--unlink") {
+      options.unlink_on_exit = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      std::fprintf(stderr, "Missing value for %s\n", argv[i]);
+      return false;
+    }
+    const char* value = argv[++i];
+    if (flag == "--ring") {
+      options.ring = value;
+    } else if (flag == "--dir") {
+      options.file.log_directory = value;
+      if (!options.file.log_directory.ends_with('/')) {
+        options.file.log_directory += '/';
+      }
+    } else if (flag == "--file") {
+      options.file.base_filename = value;
+    } else if (flag == "--slots") {
+      options.slots = std::strtoull(value, nullptr, 10);
+    } else if (flag == "--stall-ms") {
+      options.stall_timeout = std::chrono::milliseconds(std::atoi(value));
+    } else {
+      std::fprintf(stderr, "Unknown option: %s\n", argv[i - 1]);
+      return false;
+    }
+  }
+  if (options.ring.empty()) {
+    std::fprintf(stderr, "--ring is required\n");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parse(argc, argv, options)) {
+    return 2;
+  }
+
+  std::unique_ptr<log_library::internal::ShmRing> ring;
+  std::unique_ptr<log_library::Sink> sink;
+  try {
+    ring = log_library::internal::ShmRing::open(options.ring, options.slots);
+    sink = log_library::create_file_sink(options.file);
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "log_collector: %s\n", e.what());
+    return 1;
+  }
+
+  signal(SIGINT, on_stop);
+  signal(SIGTERM, on_stop);
+
+  log_library::internal::ShmRing::Record record;
+  log_library::internal::TimestampCache timestamps;
+  std::string line;
+
+  // Producers never signal the collector, so idle polling backs off up to
+  // a millisecond; a busy ring is drained without sleeping.
+  auto backoff = std::chrono::microseconds(0);
+  auto last_flush = std::chrono::steady_clock::now();
+  bool dirty = false;
+
+  const auto drain = [&] {
+    size_t drained = 0;
+    while (ring->try_read(record, options.stall_timeout)) {
+      line.clear();
+      timestamps.append(line, record.timestamp_ns);
+      std::format_to(std::back_inserter(line), " {} [{}/{}]: ",
+                     to_string(record.level), record.pid, record.thread_name);
+      line.append(record.text);
+      line.push_back('\n');
+      sink->write(line, record.level);
+      ++drained;
+    }
+    return drained;
+  };
+
+  while (!g_stop.load()) {
+    if (drain() > 0) {
+      backoff = std::chrono::microseconds(0);
+      dirty = true;
+      continue;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (dirty && now - last_flush >= std::chrono::seconds(1)) {
+      sink->flush();
+      last_flush = now;
+      dirty = false;
+    }
+
+    backoff = std::clamp(backoff * 2, std::chrono::microseconds(50),
+                         std::chrono::microseconds(1000));
+    std::this_thread::sleep_for(backoff);
+  }
+
+  drain();
+  sink->flush();
+
+  std::fprintf(stderr, "log_collector: %llu dropped, %llu abandoned\n",
+               static_cast<unsigned long long>(ring->dropped()),
+               static_cast<unsigned long long>(ring->abandoned()));
+
+  if (options.unlink_on_exit) {
+    log_library::internal::ShmRing::unlink(options.ring);
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <log_library/internal/segment_frame.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+namespace log_query {
+
+struct Frame {
+  size_t offset;
+  log_library::internal::FrameHeader header;
+
+  size_t payload_offset() const { return offset + sizeof(header); }
+  size_t end() const { return payload_offset() + header.size; }
+};
+
+// Walks the frames of a framed segment, resynchronizing past anything that
+// does not validate: torn pages, overwritten bytes, the NUL tail.
+class FrameReader {
+ public:
+  FrameReader(const char* data, size_t size) : data_(data), size_(size) {}
+
+  // First valid frame starting at or after `pos` and before `limit`.
+  std::optional<Frame> find(size_t pos, size_t limit = SIZE_MAX) const {
+    constexpr auto FIRST_BYTE =
+        static_cast<unsigned char>(log_library::internal::FRAME_MAGIC & 0xff);
+    limit = std::min(limit, size_);
+    while (pos < limit) {
+      if (auto header =
+              log_library::internal::read_frame(data_ + pos, size_ - pos)) {
+        return Frame{pos, *header};
+      }
+      const void* next = std::memchr(data_ + pos + 1, FIRST_BYTE,
+                                     limit - pos - 1);
+      if (!next) {
+        break;
+      }
+      pos = static_cast<const char*>(next) - data_;
+    }
+    return std::nullopt;
+  }
+
+  // Bisects for the first frame for which `reached` holds, assuming it
+  // holds for every frame after that one too. Also returns the frame just
+  // before it, if any.
+  template <typename Predicate>
+  std::pair<std::optional<Frame>, std::optional<Frame>> seek(
+      Predicate reached) const {
+    std::optional<Frame> before;
+    size_t lo = 0;
+    size_t hi = size_;
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      const auto frame = find(mid);
+      if (frame && !reached(*frame)) {
+        before = frame;
+        lo = frame->offset + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return {find(lo), before};
+  }
+
+  bool zero(size_t begin, size_t end) const {
+    for (size_t i = begin; i < end; ++i) {
+      if (data_[i] != '\0') {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  const char* data_;
+  size_t size_;
+};
+
+}  // namespace log_query
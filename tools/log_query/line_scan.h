@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace log_query {
+
+// Position of the first `needle` in `haystack`, or npos. Each step compares
+// the needle's first and last byte against 16 candidate positions at once
+// and only memcmp()s the positions where both match, so most of a segment
+// is rejected without looking at individual bytes.
+inline size_t find(std::string_view haystack, std::string_view needle) {
+  const size_t n = needle.size();
+  if (n == 0) {
+    return 0;
+  }
+  if (n > haystack.size()) {
+    return std::string_view::npos;
+  }
+  if (n == 1) {
+    const void* hit = std::memchr(haystack.data(), needle[0], haystack.size());
+    return hit ? static_cast<const char*>(hit) - haystack.data()
+               : std::string_view::npos;
+  }
+
+  const char* data = haystack.data();
+  // Candidate start positions are [0, candidates).
+  const size_t candidates = haystack.size() - n + 1;
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  const __m128i first = _mm_set1_epi8(needle.front());
+  const __m128i last = _mm_set1_epi8(needle.back());
+  for (; i + 16 <= candidates; i += 16) {
+    const __m128i block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    const __m128i block_last =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + n - 1));
+    auto mask = static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                                        _mm_cmpeq_epi8(last, block_last))));
+    while (mask != 0) {
+      const auto bit = static_cast<size_t>(__builtin_ctz(mask));
+      if (std::memcmp(data + i + bit + 1, needle.data() + 1, n - 2) == 0) {
+        return i + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+#endif
+
+  const auto rest = haystack.substr(i).find(needle);
+  return rest == std::string_view::npos ? rest : i + rest;
+}
+
+// Start of the line containing `pos` (the line's first byte).
+inline size_t line_start(const char* data, size_t pos) {
+  const void* hit = pos > 0 ? memrchr(data, '\n', pos) : nullptr;
+  return hit ? static_cast<const char*>(hit) - data + 1 : 0;
+}
+
+// One past the newline ending the line that contains `pos`, or `end`.
+inline size_t line_end(const char* data, size_t pos, size_t end) {
+  const void* hit = std::memchr(data + pos, '\n', end - pos);
+  return hit ? static_cast<const char*>(hit) - data + 1 : end;
+}
+
+}  // namespace log_query
@@ -0,0 +1,610 @@
+#include <log_library/config.h>
+#include <log_library/file_sink_config.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "file_rotation.h"
+#include "frame_reader.h"
+#include "line_scan.h"
+
+// Searches the segments written by the file sink, oldest first, without
+// reading the preallocated NUL tail of each segment. Segments are scanned
+// in parallel and printed in order.
+//
+// Usage: log_query [--dir DIR] [--file BASENAME] [--ext EXT]
+//                  [--level LEVEL] [--since TIME] [--until TIME]
+//                  [--thread NAME] [--grep TEXT] [--slack-ms N]
+//                  [--from-seq N] [--jobs N] [--count] [--verify]
+//                  [SEGMENT...]
+//
+// TIME is a UTC timestamp prefix such as 2026-01-31T12:00 (missing fields
+// are zero); --since is inclusive, --until exclusive. A record continues
+// over any following lines that do not start with a timestamp.
+//
+// Framed segments (FileSinkConfig::framed) are detected automatically:
+// frames that fail their CRC are reported and skipped, --from-seq seeks by
+// record sequence number, and --verify only checks the frames and reports
+// damaged regions and sequence gaps.
+
+namespace {
+
+// "2026-01-31T12:00:00.000000Z " as written by the logger.
+constexpr size_t TIMESTAMP_SIZE = 27;
+
+struct Options {
+  log_library::FileSinkConfig file;
+  std::vector<std::string> segments;
+  std::optional<LogLevel> level;
+  std::optional<int64_t> since_us;
+  std::optional<int64_t> until_us;
+  std::string thread;
+  std::string grep;
+  // How far a record's timestamp may run behind the one before it (records
+  // are written in dequeue order, stamped at enqueue). Time seeks back off
+  // by this much.
+  int64_t slack_us = 1'000'000;
+  std::optional<uint64_t> from_seq;
+  unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+  bool count = false;
+  bool verify = false;
+};
+
+int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+  y -= m <= 2;
+  const int64_t era = (y >= 0 ? y : y - 399) / 400;
+  const auto yoe = static_cast<unsigned>(y - era * 400);
+  const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// Microseconds since the epoch of "YYYY-MM-DDTHH:MM:SS.uuuuuu"; digits are
+// not validated beyond the separators the caller checked.
+int64_t parse_timestamp(const char* p) {
+  const auto number = [p](size_t at, size_t digits) {
+    int64_t value = 0;
+    for (size_t i = 0; i < digits; ++i) {
+      value = value * 10 + (p[at + i] - '0');
+    }
+    return value;
+  };
+  const int64_t days =
+      days_from_civil(number(0, 4), static_cast<unsigned>(number(5, 2)),
+                      static_cast<unsigned>(number(8, 2)));
+  const int64_t seconds =
+      days * 86400 + number(11, 2) * 3600 + number(14, 2) * 60 + number(17, 2);
+  return seconds * 1'000'000 + number(20, 6);
+}
+
+bool starts_with_timestamp(const char* p, size_t available) {
+  return available > TIMESTAMP_SIZE && p[4] == '-' && p[7] == '-' &&
+         p[10] == 'T' && p[13] == ':' && p[16] == ':' && p[19] == '.' &&
+         p[26] == 'Z' && p[27] == ' ';
+}
+
+std::optional<int64_t> parse_time_option(std::string_view value) {
+  std::string full = "0000-01-01T00:00:00.000000Z ";
+  if (value.ends_with('Z')) {
+    value.remove_suffix(1);
+  }
+  if (value.size() < 4 || value.size() > TIMESTAMP_SIZE - 1) {
+    return std::nullopt;
+  }
+  full.replace(0, value.size(), value);
+  if (!starts_with_timestamp(full.data(), full.size())) {
+    return std::nullopt;
+  }
+  return parse_timestamp(full.data());
+}
+
+std::optional<LogLevel> parse_level(std::string_view name) {
+  for (int level = LOG_LEVEL_DEBUG; level < LOG_LEVEL_NONE; ++level) {
+    if (name == to_string(static_cast<LogLevel>(level))) {
+      return static_cast<LogLevel>(level);
+    }
+  }
+  return std::nullopt;
+}
+
+bool parse(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view flag = argv[i];
+    if (!flag.starts_with("--")) {
+      options.segments.emplace_back(flag);
+      continue;
+    }
+    if (flag == "--count" || flag == "--verify") {
+      (flag == "--count" ? options.count : options.verify) = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      std::fprintf(stderr, "Missing value for %s\n", argv[i]);
+      return false;
+    }
+    const char* value = argv[++i];
+    if (flag == "--dir") {
+      options.file.log_directory = value;
+      if (!options.file.log_directory.ends_with('/')) {
+        options.file.log_directory += '/';
+      }
+    } else if (flag == "--file") {
+      options.file.base_filename = value;
+    } else if (flag == "--ext") {
+      options.file.file_extension = value;
+    } else if (flag == "--level") {
+      if (!(options.level = parse_level(value))) {
+        std::fprintf(stderr, "Unknown level: %s\n", value);
+        return false;
+      }
+    } else if (flag == "--since" || flag == "--until") {
+      const auto time = parse_time_option(value);
+      if (!time) {
+        std::fprintf(stderr, "Bad timestamp: %s\n", value);
+        return false;
+      }
+      (flag == "--since" ? options.since_us : options.until_us) = time;
+    } else if (flag == "--thread") {
+      options.thread = value;
+    } else if (flag == "--grep") {
+      options.grep = value;
+    } else if (flag == "--slack-ms") {
+      options.slack_us = std::strtoll(value, nullptr, 10) * 1000;
+    } else if (flag == "--from-seq") {
+      options.from_seq = std::strtoull(value, nullptr, 10);
+    } else if (flag == "--jobs") {
+      options.jobs = std::max(1, std::atoi(value));
+    } else {
+      std::fprintf(stderr, "Unknown option: %s\n", argv[i - 1]);
+      return false;
+    }
+  }
+  return true;
+}
+
+// A mapped segment, up to the end of its data.
+class Segment {
+ public:
+  explicit Segment(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+      mapped_size_ = static_cast<size_t>(info.st_size);
+      void* memory =
+          ::mmap(nullptr, mapped_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (memory != MAP_FAILED) {
+        data_ = static_cast<const char*>(memory);
+        // A segment is framed if a valid frame starts near its beginning,
+        // so a torn first frame does not make it read as text, and ruling
+        // out a text segment reads no more than FRAME_PROBE_BYTES of it.
+        size_ = data_end();
+        framed_ = log_query::FrameReader(data_, size_)
+                      .find(0, FRAME_PROBE_BYTES)
+                      .has_value();
+        ::madvise(memory, size_, MADV_SEQUENTIAL);
+      }
+    }
+    ::close(fd);
+  }
+
+  ~Segment() {
+    if (data_) {
+      ::munmap(const_cast<char*>(data_), mapped_size_);
+    }
+  }
+
+  Segment(const Segment&) = delete;
+  Segment& operator=(const Segment&) = delete;
+
+  const char* data() const { return data_; }
+  // Up to the end of the data.
+  size_t size() const { return size_; }
+  // Including the padding, which only --verify reads.
+  size_t mapped_size() const { return mapped_size_; }
+  bool framed() const { return framed_; }
+
+ private:
+  static constexpr size_t FRAME_PROBE_BYTES = 1024 * 1024;
+
+  // The file sink preallocates segments and writes them front to back, so
+  // the data is followed by NUL padding. Bisect for the first position
+  // where a 64-byte window is all NUL; only O(log n) pages are touched.
+  size_t data_end() const {
+    const auto zero_from = [this](size_t pos) {
+      const size_t window = std::min<size_t>(64, mapped_size_ - pos);
+      for (size_t i = 0; i < window; ++i) {
+        if (data_[pos + i] != '\0') {
+          return false;
+        }
+      }
+      return true;
+    };
+    size_t lo = 0;
+    size_t hi = mapped_size_;
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (zero_from(mid)) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    return lo;
+  }
+
+  const char* data_ = nullptr;
+  size_t mapped_size_ = 0;
+  size_t size_ = 0;
+  bool framed_ = false;
+};
+
+class Scanner {
+ public:
+  Scanner(const Options& options, const char* data, size_t size)
+      : options_(options), data_(data), end_(size) {}
+
+  // Appends matching records to `out`, ignoring the first `skip` records;
+  // returns how many matched.
+  uint64_t scan(std::string& out, uint64_t skip = 0) {
+    uint64_t matches = 0;
+    size_t pos = 0;
+    for (; skip > 0 && pos < end_; --skip) {
+      pos = record_end(pos);
+    }
+    if (options_.since_us) {
+      pos = std::max(pos, seek(*options_.since_us));
+    }
+    const bool bounded = options_.until_us.has_value();
+    const int64_t stop_us =
+        bounded ? *options_.until_us + options_.slack_us : 0;
+
+    while (pos < end_) {
+      size_t start = pos;
+      if (!options_.grep.empty()) {
+        const size_t hit = log_query::find(
+            std::string_view(data_ + pos, end_ - pos), options_.grep);
+        if (hit == std::string_view::npos) {
+          break;
+        }
+        start = std::max(pos, record_start(pos + hit));
+      }
+      const size_t next = record_end(start);
+      if (bounded && starts_with_timestamp(data_ + start, end_ - start) &&
+          parse_timestamp(data_ + start) >= stop_us) {
+        passed_until_ = true;
+        break;
+      }
+      if (matches_filters(start, next)) {
+        ++matches;
+        if (!options_.count) {
+          out.append(data_ + start, next - start);
+        }
+      }
+      pos = next;
+    }
+    return matches;
+  }
+
+  // Whether scan() stopped at a record past --until.
+  bool passed_until() const { return passed_until_; }
+
+ private:
+  bool is_record(size_t pos) const {
+    return starts_with_timestamp(data_ + pos, end_ - pos);
+  }
+
+  // First record boundary at or after `pos`.
+  size_t record_at_or_after(size_t pos) const {
+    if (pos > 0 && data_[pos - 1] != '\n') {
+      pos = log_query::line_end(data_, pos, end_);
+    }
+    while (pos < end_ && !is_record(pos)) {
+      pos = log_query::line_end(data_, pos, end_);
+    }
+    return pos;
+  }
+
+  // Start of the record containing `pos`.
+  size_t record_start(size_t pos) const {
+    pos = log_query::line_start(data_, pos);
+    while (pos > 0 && !is_record(pos)) {
+      pos = log_query::line_start(data_, pos - 1);
+    }
+    return pos;
+  }
+
+  // One past the last line of the record starting at `pos`.
+  size_t record_end(size_t pos) const {
+    pos = log_query::line_end(data_, pos, end_);
+    while (pos < end_ && !is_record(pos)) {
+      pos = log_query::line_end(data_, pos, end_);
+    }
+    return pos;
+  }
+
+  // Bisects for the first record stamped at or after `since_us` minus the
+  // slack; the exact bound is applied per record.
+  size_t seek(int64_t since_us) const {
+    const int64_t target = since_us - options_.slack_us;
+    size_t lo = 0;
+    size_t hi = end_;
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      const size_t record = record_at_or_after(mid);
+      if (record < end_ && parse_timestamp(data_ + record) < target) {
+        lo = record + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return record_at_or_after(lo);
+  }
+
+  bool matches_filters(size_t start, size_t end) const {
+    if (!options_.grep.empty() &&
+        log_query::find(std::string_view(data_ + start, end - start),
+                        options_.grep) == std::string_view::npos) {
+      return false;
+    }
+    const bool filtered = options_.level || options_.since_us ||
+                          options_.until_us || !options_.thread.empty();
+    if (!filtered) {
+      return true;
+    }
+    if (!is_record(start)) {
+      return false;
+    }
+
+    const int64_t time_us = parse_timestamp(data_ + start);
+    if ((options_.since_us && time_us < *options_.since_us) ||
+        (options_.until_us && time_us >= *options_.until_us)) {
+      return false;
+    }
+
+    // "<timestamp> LEVEL [thread]: message"
+    const std::string_view rest(data_ + start + TIMESTAMP_SIZE + 1,
+                                end - start - TIMESTAMP_SIZE - 1);
+    const size_t level_end = rest.find(' ');
+    if (options_.level) {
+      const auto level = parse_level(rest.substr(0, level_end));
+      if (!level || *level < *options_.level) {
+        return false;
+      }
+    }
+    if (!options_.thread.empty()) {
+      if (level_end == std::string_view::npos ||
+          rest.substr(level_end + 1, 1) != "[") {
+        return false;
+      }
+      const auto close = rest.find("]: ", level_end);
+      if (close == std::string_view::npos) {
+        return false;
+      }
+      // The collector writes "[pid/thread]".
+      const auto name = rest.substr(level_end + 2, close - level_end - 2);
+      if (name != options_.thread &&
+          !(name.ends_with(options_.thread) &&
+            name[name.size() - options_.thread.size() - 1] == '/')) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const Options& options_;
+  const char* data_;
+  size_t end_;
+  bool passed_until_ = false;
+};
+
+// Scans (or with --verify, only checks) the frames of a framed segment.
+uint64_t scan_framed(const Options& options, const Segment& segment,
+                     const std::string& path, std::string& out) {
+  using log_query::Frame;
+  const char* data = segment.data();
+  // Only --verify looks past the end of the data, for frames beyond a
+  // zeroed page and for damage in the padding.
+  const size_t size = options.verify ? segment.mapped_size() : segment.size();
+  const log_query::FrameReader reader(data, size);
+
+  std::optional<Frame> frame;
+  if (options.from_seq && !options.verify) {
+    frame = reader
+                .seek([&](const Frame& f) {
+                  return f.header.sequence + f.header.records >
+                         *options.from_seq;
+                })
+                .first;
+  } else if (options.since_us && !options.verify) {
+    // The frame before the first one starting at the target may still end
+    // past it.
+    const int64_t target = *options.since_us - options.slack_us;
+    const auto [at, before] = reader.seek([&](const Frame& f) {
+      const char* payload = data + f.payload_offset();
+      return starts_with_timestamp(payload, f.header.size) &&
+             parse_timestamp(payload) >= target;
+    });
+    frame = before ? before : at;
+  } else {
+    frame = reader.find(0);
+  }
+
+  uint64_t matches = 0;
+  uint64_t frames = 0;
+  uint64_t records = 0;
+  uint64_t damaged_bytes = 0;
+  uint64_t damaged_regions = 0;
+  uint64_t missing = 0;
+  std::optional<uint64_t> expected;
+  // Bytes before the first frame are damage too, unless a seek skipped
+  // them.
+  const bool sought =
+      (options.from_seq || options.since_us) && !options.verify;
+  size_t pos = frame && sought ? frame->offset : 0;
+
+  const auto damaged = [&](size_t begin, size_t end) {
+    damaged_bytes += end - begin;
+    ++damaged_regions;
+    if (!options.verify) {
+      std::fprintf(stderr, "log_query: %s: skipped damaged bytes [%zu, %zu)\n",
+                   path.c_str(), begin, end);
+    }
+  };
+
+  while (frame) {
+    if (frame->offset > pos) {
+      damaged(pos, frame->offset);
+    }
+    const auto& header = frame->header;
+    if (expected && header.sequence > *expected) {
+      missing += header.sequence - *expected;
+    }
+    expected = header.sequence + header.records;
+    ++frames;
+    records += header.records;
+
+    if (!options.verify) {
+      const uint64_t skip =
+          options.from_seq && header.sequence < *options.from_seq
+              ? *options.from_seq - header.sequence
+              : 0;
+      Scanner scanner(options, data + frame->payload_offset(), header.size);
+      matches += scanner.scan(out, skip);
+      if (scanner.passed_until()) {
+        break;
+      }
+    }
+
+    pos = frame->end();
+    frame = reader.find(pos);
+  }
+
+  if (options.verify) {
+    if (!reader.zero(pos, size)) {
+      damaged(pos, size);
+    }
+    out += std::format(
+        "{}: frames={} records={} damaged_bytes={} damaged_regions={} "
+        "missing_records={}\n",
+        path, frames, records, damaged_bytes, damaged_regions, missing);
+  }
+  return matches;
+}
+
+std::vector<std::string> default_segments(
+    const log_library::FileSinkConfig& config) {
+  auto segments =
+      log_library::FileRotationUtils::get_rotated_files_sorted(config);
+  const auto current =
+      log_library::FileRotationUtils::get_current_log_path(config);
+  if (std::filesystem::exists(current)) {
+    segments.push_back(current);
+  }
+  return segments;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parse(argc, argv, options)) {
+    return 2;
+  }
+  if (options.segments.empty()) {
+    options.segments = default_segments(options.file);
+  }
+
+  const size_t count = options.segments.size();
+  std::vector<std::optional<std::string>> results(count);
+  uint64_t total = 0;
+
+  // Workers run at most `jobs` segments ahead of the printer, so memory
+  // stays bounded by the output of that many segments.
+  std::mutex mutex;
+  std::condition_variable changed;
+  size_t next = 0;
+  size_t printed = 0;
+
+  const auto worker = [&] {
+    for (;;) {
+      size_t index;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] {
+          return next >= count || next < printed + options.jobs;
+        });
+        if (next >= count) {
+          return;
+        }
+        index = next++;
+      }
+
+      std::string out;
+      uint64_t matches = 0;
+      const Segment segment(options.segments[index]);
+      if (segment.data() && segment.framed()) {
+        matches = scan_framed(options, segment, options.segments[index], out);
+      } else if (segment.data() && options.verify) {
+        out = options.segments[index] + ": not framed\n";
+      } else if (segment.data()) {
+        matches = Scanner(options, segment.data(), segment.size()).scan(out);
+      } else {
+        std::fprintf(stderr, "log_query: cannot read %s\n",
+                     options.segments[index].c_str());
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      total += matches;
+      results[index] = std::move(out);
+      changed.notify_all();
+    }
+  };
+
+  std::vector<std::jthread> workers;
+  for (unsigned i = 0; i < std::min<size_t>(options.jobs, count); ++i) {
+    workers.emplace_back(worker);
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    std::string out;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait(lock, [&] { return results[i].has_value(); });
+      out = std::move(*results[i]);
+      results[i].reset();
+    }
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      printed = i + 1;
+    }
+    changed.notify_all();
+  }
+  workers.clear();
+
+  if (options.count) {
+    std::printf("%llu\n", static_cast<unsigned long long>(total));
+  }
+  return 0;
+}